@@ -11,12 +11,389 @@
 #include <vector>
 #include <stdexcept>
 #include <iterator>
-
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <type_traits>
+#include <cmath>
+#include <limits>
+#include "simd.hpp"
+#include "tools.hpp"
+#include "modint.hpp"
 
 namespace MZLIB
 {
+    template <typename, typename, size_t>
+    class BigInt;
+
+    // Opt-in multithreaded matrix products. A product of arithmetic matrices with
+    // at least min_work multiply-adds splits its row blocks over up to threads
+    // workers; threads<=1 (the default) stays serial.
+    inline std::atomic<size_t> gemm_threads{1};
+    inline std::atomic<size_t> gemm_parallel_min{size_t(1) << 24};
+    inline void set_gemm_parallel(size_t threads, size_t min_work = size_t(1) << 24)
+    {
+        gemm_threads.store(threads ? threads : std::max<size_t>(1, std::thread::hardware_concurrency()));
+        gemm_parallel_min.store(min_work);
+    }
+    // Element types with SIMD micro-kernels: float, double and 4- or 8-byte
+    // integers, whose products wrap lane by lane.
+    template <typename _T>
+    inline constexpr bool gemm_simd_type = std::is_same_v<_T, float> || std::is_same_v<_T, double> ||
+                                           (std::is_integral_v<_T> && !std::is_same_v<_T, bool> && (sizeof(_T) == 4 || sizeof(_T) == 8));
+    // c[m x n] += a*b over kc steps for an _MR x _NR tile, a packed _MR values
+    // per step and b _NR; m and n trim the tile at the matrix edges.
+    template <typename _T, size_t _MR, size_t _NR>
+    inline void gemm_kernel_scalar(size_t kc, const _T *a, const _T *b, _T *c, size_t ldc, size_t m, size_t n)
+    {
+        _T acc[_MR][_NR] = {};
+        for (size_t k = 0; k < kc; ++k, a += _MR, b += _NR)
+            for (size_t i = 0; i < _MR; ++i)
+                for (size_t j = 0; j < _NR; ++j)
+                    acc[i][j] += a[i] * b[j];
+        for (size_t i = 0; i < m; ++i)
+            for (size_t j = 0; j < n; ++j)
+                c[i * ldc + j] += acc[i][j];
+    }
+#if MZLIB_SIMD_X86
+    // Lane operations of the AVX2 and AVX-512 micro-kernels: madd(a, b, c) is
+    // c + a*b, fused for floating point; 64-bit integer lanes assemble the low
+    // product from three 32x32 multiplies.
+    template <typename _T>
+    struct gemm_avx2_ops
+    {
+        using vec_type = __m256i;
+        static constexpr size_t lanes = 32 / sizeof(_T);
+        MZLIB_TARGET_AVX2_FMA static vec_type zero() { return _mm256_setzero_si256(); }
+        MZLIB_TARGET_AVX2_FMA static vec_type load(const _T *p) { return _mm256_loadu_si256((const __m256i *)p); }
+        MZLIB_TARGET_AVX2_FMA static void store(_T *p, vec_type v) { _mm256_storeu_si256((__m256i *)p, v); }
+        MZLIB_TARGET_AVX2_FMA static vec_type set1(_T x)
+        {
+            if constexpr (sizeof(_T) == 4)
+                return _mm256_set1_epi32(int32_t(x));
+            else
+                return _mm256_set1_epi64x(int64_t(x));
+        }
+        MZLIB_TARGET_AVX2_FMA static vec_type add(vec_type a, vec_type b)
+        {
+            if constexpr (sizeof(_T) == 4)
+                return _mm256_add_epi32(a, b);
+            else
+                return _mm256_add_epi64(a, b);
+        }
+        MZLIB_TARGET_AVX2_FMA static vec_type madd(vec_type a, vec_type b, vec_type c)
+        {
+            if constexpr (sizeof(_T) == 4)
+                return _mm256_add_epi32(c, _mm256_mullo_epi32(a, b));
+            else
+            {
+                __m256i cross = _mm256_add_epi64(_mm256_mul_epu32(_mm256_srli_epi64(a, 32), b), _mm256_mul_epu32(a, _mm256_srli_epi64(b, 32)));
+                return _mm256_add_epi64(c, _mm256_add_epi64(_mm256_mul_epu32(a, b), _mm256_slli_epi64(cross, 32)));
+            }
+        }
+    };
+    template <>
+    struct gemm_avx2_ops<float>
+    {
+        using vec_type = __m256;
+        static constexpr size_t lanes = 8;
+        MZLIB_TARGET_AVX2_FMA static vec_type zero() { return _mm256_setzero_ps(); }
+        MZLIB_TARGET_AVX2_FMA static vec_type load(const float *p) { return _mm256_loadu_ps(p); }
+        MZLIB_TARGET_AVX2_FMA static void store(float *p, vec_type v) { _mm256_storeu_ps(p, v); }
+        MZLIB_TARGET_AVX2_FMA static vec_type set1(float x) { return _mm256_set1_ps(x); }
+        MZLIB_TARGET_AVX2_FMA static vec_type add(vec_type a, vec_type b) { return _mm256_add_ps(a, b); }
+        MZLIB_TARGET_AVX2_FMA static vec_type madd(vec_type a, vec_type b, vec_type c) { return _mm256_fmadd_ps(a, b, c); }
+    };
+    template <>
+    struct gemm_avx2_ops<double>
+    {
+        using vec_type = __m256d;
+        static constexpr size_t lanes = 4;
+        MZLIB_TARGET_AVX2_FMA static vec_type zero() { return _mm256_setzero_pd(); }
+        MZLIB_TARGET_AVX2_FMA static vec_type load(const double *p) { return _mm256_loadu_pd(p); }
+        MZLIB_TARGET_AVX2_FMA static void store(double *p, vec_type v) { _mm256_storeu_pd(p, v); }
+        MZLIB_TARGET_AVX2_FMA static vec_type set1(double x) { return _mm256_set1_pd(x); }
+        MZLIB_TARGET_AVX2_FMA static vec_type add(vec_type a, vec_type b) { return _mm256_add_pd(a, b); }
+        MZLIB_TARGET_AVX2_FMA static vec_type madd(vec_type a, vec_type b, vec_type c) { return _mm256_fmadd_pd(a, b, c); }
+    };
+    template <typename _T>
+    struct gemm_avx512_ops
+    {
+        using vec_type = __m512i;
+        static constexpr size_t lanes = 64 / sizeof(_T);
+        MZLIB_TARGET_AVX512 static vec_type zero() { return _mm512_setzero_si512(); }
+        MZLIB_TARGET_AVX512 static vec_type load(const _T *p) { return _mm512_loadu_si512(p); }
+        MZLIB_TARGET_AVX512 static void store(_T *p, vec_type v) { _mm512_storeu_si512(p, v); }
+        MZLIB_TARGET_AVX512 static vec_type set1(_T x)
+        {
+            if constexpr (sizeof(_T) == 4)
+                return _mm512_set1_epi32(int32_t(x));
+            else
+                return _mm512_set1_epi64(int64_t(x));
+        }
+        MZLIB_TARGET_AVX512 static vec_type add(vec_type a, vec_type b)
+        {
+            if constexpr (sizeof(_T) == 4)
+                return _mm512_add_epi32(a, b);
+            else
+                return _mm512_add_epi64(a, b);
+        }
+        MZLIB_TARGET_AVX512 static vec_type madd(vec_type a, vec_type b, vec_type c)
+        {
+            if constexpr (sizeof(_T) == 4)
+                return _mm512_add_epi32(c, _mm512_mullo_epi32(a, b));
+            else
+            {
+                __m512i cross = _mm512_add_epi64(_mm512_mul_epu32(_mm512_srli_epi64(a, 32), b), _mm512_mul_epu32(a, _mm512_srli_epi64(b, 32)));
+                return _mm512_add_epi64(c, _mm512_add_epi64(_mm512_mul_epu32(a, b), _mm512_slli_epi64(cross, 32)));
+            }
+        }
+    };
+    template <>
+    struct gemm_avx512_ops<float>
+    {
+        using vec_type = __m512;
+        static constexpr size_t lanes = 16;
+        MZLIB_TARGET_AVX512 static vec_type zero() { return _mm512_setzero_ps(); }
+        MZLIB_TARGET_AVX512 static vec_type load(const float *p) { return _mm512_loadu_ps(p); }
+        MZLIB_TARGET_AVX512 static void store(float *p, vec_type v) { _mm512_storeu_ps(p, v); }
+        MZLIB_TARGET_AVX512 static vec_type set1(float x) { return _mm512_set1_ps(x); }
+        MZLIB_TARGET_AVX512 static vec_type add(vec_type a, vec_type b) { return _mm512_add_ps(a, b); }
+        MZLIB_TARGET_AVX512 static vec_type madd(vec_type a, vec_type b, vec_type c) { return _mm512_fmadd_ps(a, b, c); }
+    };
+    template <>
+    struct gemm_avx512_ops<double>
+    {
+        using vec_type = __m512d;
+        static constexpr size_t lanes = 8;
+        MZLIB_TARGET_AVX512 static vec_type zero() { return _mm512_setzero_pd(); }
+        MZLIB_TARGET_AVX512 static vec_type load(const double *p) { return _mm512_loadu_pd(p); }
+        MZLIB_TARGET_AVX512 static void store(double *p, vec_type v) { _mm512_storeu_pd(p, v); }
+        MZLIB_TARGET_AVX512 static vec_type set1(double x) { return _mm512_set1_pd(x); }
+        MZLIB_TARGET_AVX512 static vec_type add(vec_type a, vec_type b) { return _mm512_add_pd(a, b); }
+        MZLIB_TARGET_AVX512 static vec_type madd(vec_type a, vec_type b, vec_type c) { return _mm512_fmadd_pd(a, b, c); }
+    };
+    // gemm_kernel_scalar with an _MR x 2-vector tile held in registers: each step
+    // loads two vectors of b and broadcasts the _MR values of a against them.
+    template <typename _T, size_t _MR>
+    MZLIB_TARGET_AVX2_FMA inline void gemm_kernel_avx2(size_t kc, const _T *a, const _T *b, _T *c, size_t ldc, size_t m, size_t n)
+    {
+        using ops = gemm_avx2_ops<_T>;
+        using vec_type = typename ops::vec_type;
+        constexpr size_t L = ops::lanes, NR = 2 * L;
+        vec_type acc[_MR][2];
+#pragma GCC unroll 16
+        for (size_t i = 0; i < _MR; ++i)
+            acc[i][0] = acc[i][1] = ops::zero();
+        for (size_t k = 0; k < kc; ++k, a += _MR, b += NR)
+        {
+            vec_type b0 = ops::load(b), b1 = ops::load(b + L);
+#pragma GCC unroll 16
+            for (size_t i = 0; i < _MR; ++i)
+            {
+                vec_type x = ops::set1(a[i]);
+                acc[i][0] = ops::madd(x, b0, acc[i][0]), acc[i][1] = ops::madd(x, b1, acc[i][1]);
+            }
+        }
+        if (m == _MR && n == NR)
+        {
+#pragma GCC unroll 16
+            for (size_t i = 0; i < _MR; ++i)
+            {
+                ops::store(c + i * ldc, ops::add(ops::load(c + i * ldc), acc[i][0]));
+                ops::store(c + i * ldc + L, ops::add(ops::load(c + i * ldc + L), acc[i][1]));
+            }
+            return;
+        }
+        _T t[_MR * NR];
+#pragma GCC unroll 16
+        for (size_t i = 0; i < _MR; ++i)
+            ops::store(t + i * NR, acc[i][0]), ops::store(t + i * NR + L, acc[i][1]);
+        for (size_t i = 0; i < m; ++i)
+            for (size_t j = 0; j < n; ++j)
+                c[i * ldc + j] += t[i * NR + j];
+    }
+    template <typename _T, size_t _MR>
+    MZLIB_TARGET_AVX512 inline void gemm_kernel_avx512(size_t kc, const _T *a, const _T *b, _T *c, size_t ldc, size_t m, size_t n)
+    {
+        using ops = gemm_avx512_ops<_T>;
+        using vec_type = typename ops::vec_type;
+        constexpr size_t L = ops::lanes, NR = 2 * L;
+        vec_type acc[_MR][2];
+#pragma GCC unroll 16
+        for (size_t i = 0; i < _MR; ++i)
+            acc[i][0] = acc[i][1] = ops::zero();
+        for (size_t k = 0; k < kc; ++k, a += _MR, b += NR)
+        {
+            vec_type b0 = ops::load(b), b1 = ops::load(b + L);
+#pragma GCC unroll 16
+            for (size_t i = 0; i < _MR; ++i)
+            {
+                vec_type x = ops::set1(a[i]);
+                acc[i][0] = ops::madd(x, b0, acc[i][0]), acc[i][1] = ops::madd(x, b1, acc[i][1]);
+            }
+        }
+        if (m == _MR && n == NR)
+        {
+#pragma GCC unroll 16
+            for (size_t i = 0; i < _MR; ++i)
+            {
+                ops::store(c + i * ldc, ops::add(ops::load(c + i * ldc), acc[i][0]));
+                ops::store(c + i * ldc + L, ops::add(ops::load(c + i * ldc + L), acc[i][1]));
+            }
+            return;
+        }
+        _T t[_MR * NR];
+#pragma GCC unroll 16
+        for (size_t i = 0; i < _MR; ++i)
+            ops::store(t + i * NR, acc[i][0]), ops::store(t + i * NR + L, acc[i][1]);
+        for (size_t i = 0; i < m; ++i)
+            for (size_t j = 0; j < n; ++j)
+                c[i * ldc + j] += t[i * NR + j];
+    }
+#endif
+    // C[M x N] += A[M x K] * B[K x N], all row-major and dense. Loops are blocked
+    // as in BLIS: B is packed KC rows by NC columns at a time into slivers _NR
+    // wide, each MC-row block of A into slivers _MR tall, both zero-padded, so
+    // the micro-kernel streams one A sliver from L2 against one B sliver from L1.
+    // The row blocks of A are shared out among the threads.
+    template <typename _T, size_t _MR, size_t _NR>
+    inline void gemm_blocked(size_t M, size_t N, size_t K, const _T *A, const _T *B, _T *C, size_t threads,
+                             void (*kernel)(size_t, const _T *, const _T *, _T *, size_t, size_t, size_t))
+    {
+        constexpr size_t KC = 2048 / sizeof(_T), MC = 120, NC = 4096;
+        static_assert(MC % _MR == 0 && NC % _NR == 0, "GEMM blocks must hold whole slivers");
+        std::unique_ptr<_T[]> bp(new _T[KC * std::min(NC, (N + _NR - 1) / _NR * _NR)]);
+        for (size_t jc = 0; jc < N; jc += NC)
+        {
+            size_t nc = std::min(NC, N - jc);
+            for (size_t pc = 0; pc < K; pc += KC)
+            {
+                size_t kc = std::min(KC, K - pc);
+                for (size_t t = 0; t * _NR < nc; ++t)
+                {
+                    _T *dst = bp.get() + t * _NR * kc;
+                    size_t w = std::min(_NR, nc - t * _NR);
+                    for (size_t k = 0; k < kc; ++k, dst += _NR)
+                    {
+                        const _T *src = B + (pc + k) * N + jc + t * _NR;
+                        std::copy(src, src + w, dst);
+                        std::fill(dst + w, dst + _NR, _T());
+                    }
+                }
+                auto block = [&](size_t blk)
+                {
+                    size_t ic = blk * MC, mc = std::min(MC, M - ic);
+                    std::unique_ptr<_T[]> ap(new _T[MC * kc]);
+                    for (size_t s = 0; s * _MR < mc; ++s)
+                    {
+                        _T *dst = ap.get() + s * _MR * kc;
+                        size_t h = std::min(_MR, mc - s * _MR);
+                        for (size_t k = 0; k < kc; ++k, dst += _MR)
+                        {
+                            for (size_t i = 0; i < h; ++i)
+                                dst[i] = A[(ic + s * _MR + i) * K + pc + k];
+                            std::fill(dst + h, dst + _MR, _T());
+                        }
+                    }
+                    for (size_t t = 0; t * _NR < nc; ++t)
+                        for (size_t s = 0; s * _MR < mc; ++s)
+                            kernel(kc, ap.get() + s * _MR * kc, bp.get() + t * _NR * kc, C + (ic + s * _MR) * N + jc + t * _NR, N,
+                                   std::min(_MR, mc - s * _MR), std::min(_NR, nc - t * _NR));
+                };
+                parallel_run((M + MC - 1) / MC, threads, block);
+            }
+        }
+    }
+    // C += A*B for row-major arrays of an arithmetic type; isa caps the
+    // instruction set (AVX2 kernels also need FMA).
+    template <typename _T>
+    inline void gemm(size_t M, size_t N, size_t K, const _T *A, const _T *B, _T *C, simd_isa isa = simd_level())
+    {
+        static_assert(std::is_arithmetic_v<_T>, "gemm needs an arithmetic element type");
+        size_t threads = M * N * K >= gemm_parallel_min.load(std::memory_order_relaxed) ? gemm_threads.load(std::memory_order_relaxed) : 1;
+#if MZLIB_SIMD_X86
+        if constexpr (gemm_simd_type<_T>)
+        {
+            if (isa == simd_isa::avx512)
+                return gemm_blocked<_T, 12, 128 / sizeof(_T)>(M, N, K, A, B, C, threads, gemm_kernel_avx512<_T, 12>);
+            if (isa == simd_isa::avx2 && simd_fma())
+                return gemm_blocked<_T, 6, 64 / sizeof(_T)>(M, N, K, A, B, C, threads, gemm_kernel_avx2<_T, 6>);
+        }
+#endif
+        (void)isa;
+        gemm_blocked<_T, 4, 4>(M, N, K, A, B, C, threads, gemm_kernel_scalar<_T, 4, 4>);
+    }
+    // ModInt element types, whose products take the lazy-reduction path below.
+    template <typename _T>
+    inline constexpr bool gemm_modint_type = false;
+    template <size_t _MOD, typename _V>
+    inline constexpr bool gemm_modint_type<ModInt<_MOD, _V>> = true;
+    // C += A*B for row-major ModInt arrays. B is transposed into bt so each entry
+    // is one vec_dot, which sums the raw products in 128 bits and reduces once
+    // per entry instead of once per term. Rows go in blocks of MB against column
+    // panels of NB, keeping a panel of bt cached across the block.
+    template <typename _T>
+    inline void gemm_modint(size_t M, size_t N, size_t K, const _T *A, const _T *B, _T *C, std::vector<_T> &bt)
+    {
+        constexpr size_t MB = 16, NB = 64;
+        bt.resize(N * K);
+        for (size_t k = 0; k < K; ++k)
+            for (size_t j = 0; j < N; ++j)
+                bt[j * K + k] = B[k * N + j];
+        size_t threads = M * N * K >= gemm_parallel_min.load(std::memory_order_relaxed) ? gemm_threads.load(std::memory_order_relaxed) : 1;
+        auto block = [&](size_t blk)
+        {
+            size_t i0 = blk * MB, i1 = std::min(M, i0 + MB);
+            for (size_t j0 = 0; j0 < N; j0 += NB)
+                for (size_t i = i0; i < i1; ++i)
+                    for (size_t j = j0, j1 = std::min(N, j0 + NB); j < j1; ++j)
+                        C[i * N + j] += vec_dot(A + i * K, bt.data() + j * K, K);
+        };
+        parallel_run((M + MB - 1) / MB, threads, block);
+    }
+
+    template <typename _T>
+    class Matrix;
+    template <typename _T>
+    class MatrixLeaf;
+    template <typename _E>
+    struct matrix_node;
+    template <typename _T>
+    class PLU;
+    // Lazy matrix expressions, opted into with lazy(m). Arithmetic on plain
+    // matrices yields a Matrix as always; once an operand is an expression,
+    // sums, differences, scalings, transposes and products build small nodes
+    // instead of temporaries. Assigning one to a Matrix fills every element in
+    // a single fused pass over the element-wise terms, then adds each top-level
+    // product into the destination with one multiply-accumulate, so
+    // C += alpha * lazy(A) * B touches C once. Products nested anywhere else,
+    // and operands that are themselves expressions, are evaluated into
+    // temporaries. Named matrices are held by reference and temporaries by
+    // value, so an expression must not outlive the named matrices in it.
+    template <typename _E>
+    class MatrixExpr
+    {
+    public:
+        const _E &derived() const noexcept { return static_cast<const _E &>(*this); }
+        // the Matrix this expression stands for
+        auto eval() const { return Matrix<typename _E::element_type>(derived()); }
+        // read-only rows, so x[i][j] reads x(i, j) as it would on a Matrix
+        auto operator[](size_t i) const
+        {
+            struct row
+            {
+                const _E &x;
+                size_t i;
+                auto operator[](size_t j) const { return x(i, j); }
+            };
+            return row{derived(), i};
+        }
+    };
+
     template <typename _T = int>
-    class Matrix
+    class Matrix : public MatrixExpr<Matrix<_T>>
     {
     public:
         using element_type = _T;
@@ -47,9 +424,19 @@ namespace MZLIB
         inline constexpr size_t getH() const noexcept { return _H; }
         inline constexpr size_t getW() const noexcept { return _W; }
         inline constexpr size_t size() const noexcept { return _H * _W; }
+        inline pointer data() noexcept { return _dat.data(); }
+        inline const_pointer data() const noexcept { return _dat.data(); }
 
-        Matrix &operator+=(const Matrix &x) { return (*this) = (*this) + x; }
-        Matrix &operator*=(const Matrix &x) { return (*this) = (*this) * x; }
+        template <typename _E>
+        Matrix(const MatrixExpr<_E> &x) : Matrix(0, 0) { assign(matrix_node<_E>::get(x.derived()), false); }
+        template <typename _E>
+        Matrix &operator=(const MatrixExpr<_E> &x) { return assign(matrix_node<_E>::get(x.derived()), false); }
+        template <typename _E>
+        Matrix &operator+=(const MatrixExpr<_E> &x) { return assign(matrix_node<_E>::get(x.derived()), true); }
+        template <typename _E>
+        Matrix &operator-=(const MatrixExpr<_E> &x) { return assign(matrix_node<_E>::get(x.derived()) * (element_type(0) - element_type(1)), true); }
+        template <typename _E>
+        Matrix &operator*=(const MatrixExpr<_E> &x) { return (*this) = (*this) * x.derived(); }
         Matrix &operator*=(element_type x) { return (*this) = (*this) * x; }
 
         using iterator = typename std::vector<element_type>::iterator;
@@ -74,41 +461,7 @@ namespace MZLIB
         {
             if (_H != _W)
                 throw std::invalid_argument("invalid matrix size to compute inverse");
-            Matrix<element_type> augmented(_H, _W * 2);
-            for (size_t i = 0; i < _H; ++i)
-            {
-                for (size_t j = 0; j < _W; ++j)
-                    augmented[i][j] = _dat[i * _W + j],
-                    augmented[i][j + _W] = (i == j) ? 1 : 0;
-            }
-            for (size_t i = 0; i < _H; ++i)
-            {
-                size_t pivot = i;
-                for (size_t j = i + 1; j < _H; ++j)
-                    if (std::abs(augmented[j][i]) > std::abs(augmented[pivot][i]))
-                        pivot = j;
-                if (pivot != i)
-                    std::swap_ranges(augmented[i], augmented[i] + _W * 2, augmented[pivot]);
-                element_type scale = augmented[i][i];
-                if (std::abs(scale) < 1e-9)
-                    throw std::runtime_error("matrix is singular and cannot be inverted");
-                for (size_t j = i; j < _W * 2; ++j)
-                    augmented[i][j] = augmented[i][j] / scale;
-                for (size_t j = 0; j < _H; ++j)
-                {
-                    if (j == i)
-                        continue;
-                    element_type factor = augmented[j][i];
-                    for (size_t k = i; k < _W * 2; ++k)
-                        augmented[j][k] = augmented[j][k] - factor * augmented[i][k];
-                }
-            }
-            Matrix<element_type> inv(_H, _W);
-            for (size_t i = 0; i < _H; ++i)
-                for (size_t j = 0; j < _W; ++j)
-                    inv[i][j] = augmented[i][j + _W];
-
-            return inv;
+            return PLU<element_type>(*this).inverse();
         }
 
         inline static Matrix<element_type> identity(size_t n)
@@ -118,53 +471,793 @@ namespace MZLIB
                 mat[i][i] = element_type(1);
             return mat;
         }
+        // this^e for a square matrix by binary powering. The running product, the
+        // power of this and the ModInt path's transposed operand cycle through
+        // the same buffers instead of a fresh matrix per multiply.
+        inline Matrix<element_type> pow(uint64_t e) const
+        {
+            if (_H != _W)
+                throw std::invalid_argument("invalid matrix size to compute power");
+            Matrix<element_type> res = identity(_H), base = *this, tmp(0, 0);
+            std::vector<element_type> scratch;
+            for (bool started = false; e; e >>= 1)
+            {
+                if (e & 1)
+                {
+                    if (started)
+                        multiply(tmp, res, base, scratch), std::swap(res, tmp);
+                    else
+                        res = base, started = true;
+                }
+                if (e > 1)
+                    multiply(tmp, base, base, scratch), std::swap(base, tmp);
+            }
+            return res;
+        }
+        // res = x*y in res's storage, which must not be x's or y's; scratch
+        // holds the ModInt path's transposed copy of y between calls.
+        static void multiply(Matrix &res, const Matrix &x, const Matrix &y, std::vector<element_type> &scratch)
+        {
+            res._H = x._H, res._W = y._W;
+            res._dat.assign(res.size(), element_type());
+            multiply_add(res, x, y, scratch);
+        }
+        // res += x*y under the same rules as multiply
+        static void multiply_add(Matrix &res, const Matrix &x, const Matrix &y, std::vector<element_type> &scratch)
+        {
+            if (x._W != y._H || res._H != x._H || res._W != y._W)
+                throw std::invalid_argument("invalid matrix size");
+            size_t _Hx = x._H, _Wy = y._W, _HW = x._W;
+            if constexpr (gemm_modint_type<element_type>)
+                gemm_modint(_Hx, _Wy, _HW, x.data(), y.data(), res.data(), scratch);
+            else
+            {
+                (void)scratch;
+                // arithmetic types go through the blocked kernels once packing pays off
+                if constexpr (std::is_arithmetic_v<element_type> && !std::is_same_v<element_type, bool>)
+                    if (_Hx * _Wy * _HW >= 4096)
+                        return gemm(_Hx, _Wy, _HW, x.data(), y.data(), res.data());
+                for (size_t i = 0; i < _Hx; ++i)
+                    for (size_t j = 0; j < _Wy; ++j)
+                        for (size_t k = 0; k < _HW; ++k)
+                            res[i][j] = res[i][j] + x[i][k] * y[k][j];
+            }
+        }
 
     private:
         size_t _H, _W;
         std::vector<element_type> _dat;
+
+        // *this = x, or *this += x when add is set; an empty side of a sum
+        // stands for zero. The element-wise pass may read *this at the element
+        // it writes, so only an x that reads it through a transpose or a
+        // product is evaluated aside first.
+        template <typename _E>
+        Matrix &assign(const _E &x, bool add)
+        {
+            if (x.crosses(this))
+            {
+                Matrix tmp(x);
+                return add ? assign(MatrixLeaf<element_type>(tmp), true) : (*this) = std::move(tmp);
+            }
+            if (add && size())
+            {
+                if (!x.size())
+                    return *this;
+                if (x.getH() != _H || x.getW() != _W)
+                    throw std::invalid_argument("invalid matrix size");
+                for (size_t i = 0, p = 0; i < _H; ++i)
+                    for (size_t j = 0; j < _W; ++j, ++p)
+                        _dat[p] = _dat[p] + x.template get<true>(i, j);
+            }
+            else
+            {
+                _H = x.getH(), _W = x.getW();
+                _dat.resize(size());
+                for (size_t i = 0, p = 0; i < _H; ++i)
+                    for (size_t j = 0; j < _W; ++j, ++p)
+                        _dat[p] = x.template get<true>(i, j);
+            }
+            std::vector<element_type> scratch;
+            x.add_products(*this, element_type(1), scratch);
+            return *this;
+        }
     };
 
+    // Expression nodes. Each has the element_type, getH, getW and size of the
+    // matrix it stands for and reads elements with operator()(i, j). The
+    // evaluation hooks are get<fused>(i, j), which with fused set leaves out
+    // top-level products; add_products(dst, coef, scratch), which adds coef
+    // times those products into dst; and reads(m) and crosses(m), which report
+    // whether the expression reads the matrix at m at all or at elements other
+    // than the one being written.
+    // A Matrix operand: a named matrix by reference, a temporary moved into
+    // shared storage so that copies of the node stay cheap.
     template <typename _T>
-    inline Matrix<_T> operator*(const Matrix<_T> &x, const Matrix<_T> &y)
+    class MatrixLeaf : public MatrixExpr<MatrixLeaf<_T>>
     {
-        if (!x.size())
-            return x;
-        if (!y.size())
-            return y;
-        if (x.getW() != y.getH())
-            throw std::invalid_argument("invalid matrix size");
-        size_t _Hx = x.getH(), _Wy = y.getW(), _HW = x.getW();
-        Matrix<_T> res(_Hx, _Wy);
-        for (size_t i = 0; i < _Hx; ++i)
-            for (size_t j = 0; j < _Wy; ++j)
-                for (size_t k = 0; k < _HW; ++k)
-                    res[i][j] = res[i][j] + x[i][k] * y[k][j];
-        return res;
+    public:
+        using element_type = _T;
+
+        explicit MatrixLeaf(const Matrix<_T> &m) noexcept : _m(&m) {}
+        explicit MatrixLeaf(Matrix<_T> &&m) : _own(std::make_shared<const Matrix<_T>>(std::move(m))) { _m = _own.get(); }
+        const Matrix<_T> &matrix() const noexcept { return *_m; }
+        size_t getH() const noexcept { return _m->getH(); }
+        size_t getW() const noexcept { return _m->getW(); }
+        size_t size() const noexcept { return _m->size(); }
+        _T operator()(size_t i, size_t j) const { return _m->data()[i * _m->getW() + j]; }
+
+        template <bool _FUSED>
+        _T get(size_t i, size_t j) const { return (*this)(i, j); }
+        void add_products(Matrix<_T> &, const _T &, std::vector<_T> &) const {}
+        bool reads(const void *m) const noexcept { return _m == m; }
+        bool crosses(const void *) const noexcept { return false; }
+
+    private:
+        const Matrix<_T> *_m;
+        std::shared_ptr<const Matrix<_T>> _own;
+    };
+    // Operands are stored as nodes: a Matrix as a MatrixLeaf, a node by value.
+    template <typename _E>
+    struct matrix_node
+    {
+        using type = _E;
+        static const _E &get(const _E &x) noexcept { return x; }
+    };
+    template <typename _T>
+    struct matrix_node<Matrix<_T>>
+    {
+        using type = MatrixLeaf<_T>;
+        static MatrixLeaf<_T> get(const Matrix<_T> &x) noexcept { return MatrixLeaf<_T>(x); }
+    };
+    template <typename _E>
+    using matrix_node_t = typename matrix_node<_E>::type;
+    template <typename _E>
+    inline constexpr bool matrix_type = false;
+    template <typename _T>
+    inline constexpr bool matrix_type<Matrix<_T>> = true;
+    // the operator overloads below build nodes unless every operand is a Matrix
+    template <typename... _E>
+    using enable_lazy = std::enable_if_t<!(matrix_type<_E> && ...), int>;
+    // x or x - y; an empty operand stands for zero, as in Matrix addition
+    template <typename _L, typename _R, bool _SUB>
+    class MatrixSum : public MatrixExpr<MatrixSum<_L, _R, _SUB>>
+    {
+    public:
+        using element_type = typename _L::element_type;
+        static_assert(std::is_same_v<element_type, typename _R::element_type>, "matrix element types do not match");
+
+        MatrixSum(const _L &l, const _R &r) : _l(l), _r(r), _lz(!l.size()), _rz(!r.size())
+        {
+            if (!_lz && !_rz && (l.getH() != r.getH() || l.getW() != r.getW()))
+                throw std::invalid_argument("invalid matrix size");
+            _H = _lz ? r.getH() : l.getH(), _W = _lz ? r.getW() : l.getW();
+        }
+        size_t getH() const noexcept { return _H; }
+        size_t getW() const noexcept { return _W; }
+        size_t size() const noexcept { return _H * _W; }
+        element_type operator()(size_t i, size_t j) const { return get<false>(i, j); }
+
+        template <bool _FUSED>
+        element_type get(size_t i, size_t j) const
+        {
+            if (_rz)
+                return _l.template get<_FUSED>(i, j);
+            if constexpr (_SUB)
+                return (_lz ? element_type(0) : _l.template get<_FUSED>(i, j)) - _r.template get<_FUSED>(i, j);
+            else
+                return _lz ? _r.template get<_FUSED>(i, j) : _l.template get<_FUSED>(i, j) + _r.template get<_FUSED>(i, j);
+        }
+        void add_products(Matrix<element_type> &dst, const element_type &coef, std::vector<element_type> &scratch) const
+        {
+            if (!_lz)
+                _l.add_products(dst, coef, scratch);
+            if (!_rz)
+                _r.add_products(dst, _SUB ? element_type(0) - coef : coef, scratch);
+        }
+        bool reads(const void *m) const { return _l.reads(m) || _r.reads(m); }
+        bool crosses(const void *m) const { return _l.crosses(m) || _r.crosses(m); }
+
+    private:
+        _L _l;
+        _R _r;
+        bool _lz, _rz;
+        size_t _H, _W;
+    };
+    // x * a for a scalar a
+    template <typename _E>
+    class MatrixScale : public MatrixExpr<MatrixScale<_E>>
+    {
+    public:
+        using element_type = typename _E::element_type;
+
+        MatrixScale(const _E &x, const element_type &a) : _x(x), _a(a) {}
+        size_t getH() const noexcept { return _x.getH(); }
+        size_t getW() const noexcept { return _x.getW(); }
+        size_t size() const noexcept { return _x.size(); }
+        element_type operator()(size_t i, size_t j) const { return get<false>(i, j); }
+
+        template <bool _FUSED>
+        element_type get(size_t i, size_t j) const { return _x.template get<_FUSED>(i, j) * _a; }
+        void add_products(Matrix<element_type> &dst, const element_type &coef, std::vector<element_type> &scratch) const
+        {
+            _x.add_products(dst, coef * _a, scratch);
+        }
+        bool reads(const void *m) const { return _x.reads(m); }
+        bool crosses(const void *m) const { return _x.crosses(m); }
+
+    private:
+        _E _x;
+        element_type _a;
+    };
+    template <typename _E>
+    class MatrixTranspose : public MatrixExpr<MatrixTranspose<_E>>
+    {
+    public:
+        using element_type = typename _E::element_type;
+
+        explicit MatrixTranspose(const _E &x) : _x(x) {}
+        size_t getH() const noexcept { return _x.getW(); }
+        size_t getW() const noexcept { return _x.getH(); }
+        size_t size() const noexcept { return _x.size(); }
+        element_type operator()(size_t i, size_t j) const { return _x(j, i); }
+
+        template <bool _FUSED>
+        element_type get(size_t i, size_t j) const { return _x(j, i); }
+        void add_products(Matrix<element_type> &, const element_type &, std::vector<element_type> &) const {}
+        bool reads(const void *m) const { return _x.reads(m); }
+        bool crosses(const void *m) const { return _x.reads(m); }
+
+    private:
+        _E _x;
+    };
+    // x * y. At the top level of a sum it is added into the destination by
+    // Matrix::multiply_add, a coefficient scaling the smaller operand; read
+    // element by element it is evaluated once into a cached matrix. An empty
+    // operand makes the product that operand, as in Matrix multiplication.
+    template <typename _L, typename _R>
+    class MatrixProduct : public MatrixExpr<MatrixProduct<_L, _R>>
+    {
+    public:
+        using element_type = typename _L::element_type;
+        static_assert(std::is_same_v<element_type, typename _R::element_type>, "matrix element types do not match");
+
+        MatrixProduct(const _L &l, const _R &r) : _l(l), _r(r), _val(0, 0)
+        {
+            if (l.size() && r.size() && l.getW() != r.getH())
+                throw std::invalid_argument("invalid matrix size");
+            _H = !l.size() ? l.getH() : !r.size() ? r.getH() : l.getH();
+            _W = !l.size() ? l.getW() : !r.size() ? r.getW() : r.getW();
+        }
+        size_t getH() const noexcept { return _H; }
+        size_t getW() const noexcept { return _W; }
+        size_t size() const noexcept { return _H * _W; }
+        element_type operator()(size_t i, size_t j) const { return get<false>(i, j); }
+
+        template <bool _FUSED>
+        element_type get(size_t i, size_t j) const
+        {
+            if constexpr (_FUSED)
+                return element_type(0);
+            else
+            {
+                if (!_done)
+                {
+                    _val = Matrix<element_type>(_H, _W);
+                    std::vector<element_type> scratch;
+                    add_products(_val, element_type(1), scratch);
+                    _done = true;
+                }
+                return _val.data()[i * _W + j];
+            }
+        }
+        void add_products(Matrix<element_type> &dst, const element_type &coef, std::vector<element_type> &scratch) const
+        {
+            if (!size())
+                return;
+            Matrix<element_type> lt(0, 0), rt(0, 0);
+            const Matrix<element_type> *a = &operand(_l, lt), *b = &operand(_r, rt);
+            if (!(coef == element_type(1)))
+            {
+                bool left = a->size() <= b->size();
+                Matrix<element_type> &t = left ? lt : rt;
+                t = (*(left ? a : b)) * coef;
+                (left ? a : b) = &t;
+            }
+            Matrix<element_type>::multiply_add(dst, *a, *b, scratch);
+        }
+        bool reads(const void *m) const { return _l.reads(m) || _r.reads(m); }
+        bool crosses(const void *m) const { return reads(m); }
+
+    private:
+        _L _l;
+        _R _r;
+        size_t _H, _W;
+        mutable Matrix<element_type> _val;
+        mutable bool _done = false;
+
+        template <typename _E>
+        static const Matrix<element_type> &operand(const _E &x, Matrix<element_type> &tmp)
+        {
+            if constexpr (std::is_same_v<_E, MatrixLeaf<element_type>>)
+                return x.matrix();
+            else
+                return tmp = x;
+        }
+    };
+
+    // lazy(m) starts an expression on m: a named matrix is referenced, a
+    // temporary is kept alive inside the expression.
+    template <typename _T>
+    inline MatrixLeaf<_T> lazy(const Matrix<_T> &x) noexcept { return MatrixLeaf<_T>(x); }
+    template <typename _T>
+    inline MatrixLeaf<_T> lazy(Matrix<_T> &&x) { return MatrixLeaf<_T>(std::move(x)); }
+
+    template <typename _L, typename _R, enable_lazy<_L, _R> = 0>
+    inline MatrixSum<matrix_node_t<_L>, matrix_node_t<_R>, false> operator+(const MatrixExpr<_L> &x, const MatrixExpr<_R> &y)
+    {
+        return {matrix_node<_L>::get(x.derived()), matrix_node<_R>::get(y.derived())};
+    }
+    template <typename _L, typename _R, enable_lazy<_L, _R> = 0>
+    inline MatrixSum<matrix_node_t<_L>, matrix_node_t<_R>, true> operator-(const MatrixExpr<_L> &x, const MatrixExpr<_R> &y)
+    {
+        return {matrix_node<_L>::get(x.derived()), matrix_node<_R>::get(y.derived())};
+    }
+    template <typename _L, typename _R, enable_lazy<_L, _R> = 0>
+    inline MatrixProduct<matrix_node_t<_L>, matrix_node_t<_R>> operator*(const MatrixExpr<_L> &x, const MatrixExpr<_R> &y)
+    {
+        return {matrix_node<_L>::get(x.derived()), matrix_node<_R>::get(y.derived())};
+    }
+    // a temporary Matrix next to an expression is moved into it
+    template <typename _T, typename _R, enable_lazy<_R> = 0>
+    inline MatrixSum<MatrixLeaf<_T>, _R, false> operator+(Matrix<_T> &&x, const MatrixExpr<_R> &y) { return {MatrixLeaf<_T>(std::move(x)), y.derived()}; }
+    template <typename _L, typename _T, enable_lazy<_L> = 0>
+    inline MatrixSum<_L, MatrixLeaf<_T>, false> operator+(const MatrixExpr<_L> &x, Matrix<_T> &&y) { return {x.derived(), MatrixLeaf<_T>(std::move(y))}; }
+    template <typename _T, typename _R, enable_lazy<_R> = 0>
+    inline MatrixSum<MatrixLeaf<_T>, _R, true> operator-(Matrix<_T> &&x, const MatrixExpr<_R> &y) { return {MatrixLeaf<_T>(std::move(x)), y.derived()}; }
+    template <typename _L, typename _T, enable_lazy<_L> = 0>
+    inline MatrixSum<_L, MatrixLeaf<_T>, true> operator-(const MatrixExpr<_L> &x, Matrix<_T> &&y) { return {x.derived(), MatrixLeaf<_T>(std::move(y))}; }
+    template <typename _T, typename _R, enable_lazy<_R> = 0>
+    inline MatrixProduct<MatrixLeaf<_T>, _R> operator*(Matrix<_T> &&x, const MatrixExpr<_R> &y) { return {MatrixLeaf<_T>(std::move(x)), y.derived()}; }
+    template <typename _L, typename _T, enable_lazy<_L> = 0>
+    inline MatrixProduct<_L, MatrixLeaf<_T>> operator*(const MatrixExpr<_L> &x, Matrix<_T> &&y) { return {x.derived(), MatrixLeaf<_T>(std::move(y))}; }
+    template <typename _E, enable_lazy<_E> = 0>
+    inline MatrixScale<_E> operator*(const MatrixExpr<_E> &x, const typename _E::element_type &y) { return {x.derived(), y}; }
+    template <typename _E, enable_lazy<_E> = 0>
+    inline MatrixScale<_E> operator*(const typename _E::element_type &y, const MatrixExpr<_E> &x) { return x * y; }
+    template <typename _E, enable_lazy<_E> = 0>
+    inline MatrixScale<_E> operator-(const MatrixExpr<_E> &x)
+    {
+        using _T = typename _E::element_type;
+        return x * (_T(0) - _T(1));
     }
+    template <typename _E, enable_lazy<_E> = 0>
+    inline MatrixTranspose<_E> transpose(const MatrixExpr<_E> &x) { return MatrixTranspose<_E>(x.derived()); }
+
+    // Plain matrices evaluate at once, through the same fused passes.
+    template <typename _T>
+    inline Matrix<_T> operator+(const Matrix<_T> &x, const Matrix<_T> &y) { return lazy(x) + lazy(y); }
     template <typename _T>
-    inline Matrix<_T> operator*(const Matrix<_T> &x, _T y)
+    inline Matrix<_T> operator-(const Matrix<_T> &x, const Matrix<_T> &y) { return lazy(x) - lazy(y); }
+    template <typename _T>
+    inline Matrix<_T> operator*(const Matrix<_T> &x, const Matrix<_T> &y) { return lazy(x) * lazy(y); }
+    template <typename _T>
+    inline Matrix<_T> operator*(const Matrix<_T> &x, const typename Matrix<_T>::element_type &y) { return lazy(x) * y; }
+    template <typename _T>
+    inline Matrix<_T> operator*(const typename Matrix<_T>::element_type &y, const Matrix<_T> &x) { return lazy(x) * y; }
+    template <typename _T>
+    inline Matrix<_T> operator-(const Matrix<_T> &x) { return -lazy(x); }
+    template <typename _T>
+    inline Matrix<_T> transpose(const Matrix<_T> &x) { return transpose(lazy(x)); }
+    // The e-th term of the recurrence a[n] = c[0]*a[n-1] + ... + c[d-1]*a[n-d]
+    // from a[0, d): the power of its companion matrix, taken by Kitamasa's method
+    // as x^e modulo the characteristic polynomial x^d - c[0]*x^(d-1) - ... - c[d-1].
+    // Each step squares a polynomial of degree below d and folds it back, O(d^2)
+    // against the O(d^3) of a Matrix::pow step. ModInt squares go through vec_dot
+    // against the reversed polynomial, one lazy reduction per coefficient.
+    template <typename _T>
+    inline _T kitamasa(const std::vector<_T> &c, const std::vector<_T> &a, uint64_t e)
     {
-        Matrix<_T> res = x;
-        for (auto &val : res)
-            val = val * y;
+        size_t d = c.size();
+        if (!d || a.size() != d)
+            throw std::invalid_argument("invalid recurrence size");
+        if (e < d)
+            return a[e];
+        std::vector<_T> r(d, _T(0)), rev(d), sq(2 * d - 1);
+        r[0] = _T(1);
+        for (int b = 63 - __builtin_clzll(e); b >= 0; --b)
+        {
+            if constexpr (gemm_modint_type<_T>)
+            {
+                std::reverse_copy(r.begin(), r.end(), rev.begin());
+                for (size_t k = 0; k < 2 * d - 1; ++k)
+                {
+                    size_t lo = k < d ? 0 : k - d + 1, hi = std::min(k, d - 1);
+                    sq[k] = vec_dot(r.data() + lo, rev.data() + (d - 1 - k + lo), hi - lo + 1);
+                }
+            }
+            else
+            {
+                std::fill(sq.begin(), sq.end(), _T(0));
+                for (size_t i = 0; i < d; ++i)
+                    for (size_t j = 0; j < d; ++j)
+                        sq[i + j] = sq[i + j] + r[i] * r[j];
+            }
+            // x^k = c[0]*x^(k-1) + ... + c[d-1]*x^(k-d) for k >= d, top down
+            for (size_t k = 2 * d - 2; k >= d; --k)
+                for (size_t j = 0; j < d; ++j)
+                    sq[k - 1 - j] = sq[k - 1 - j] + sq[k] * c[j];
+            std::copy(sq.begin(), sq.begin() + d, r.begin());
+            if (e >> b & 1)
+            {
+                _T top = r[d - 1];
+                for (size_t k = d - 1; k; --k)
+                    r[k] = r[k - 1];
+                r[0] = _T(0);
+                for (size_t j = 0; j < d; ++j)
+                    r[d - 1 - j] = r[d - 1 - j] + top * c[j];
+            }
+        }
+        _T res = _T(0);
+        for (size_t i = 0; i < d; ++i)
+            res = res + r[i] * a[i];
         return res;
     }
+
+    // How PLU picks pivots: the largest magnitude abs(x) for floating point,
+    // std::complex and any type not listed here, the first nonzero entry for
+    // ModInt and DynamicModInt, and fraction-free Bareiss elimination for
+    // integers and BigInt, where every division is exact. Other exact fields
+    // opt into nonzero by specializing lu_pivoting_of.
+    enum class lu_pivoting
+    {
+        magnitude,
+        nonzero,
+        bareiss
+    };
     template <typename _T>
-    inline Matrix<_T> operator*(_T y, const Matrix<_T> &x) { return x * y; }
+    inline constexpr lu_pivoting lu_pivoting_of = std::is_integral_v<_T> ? lu_pivoting::bareiss : lu_pivoting::magnitude;
+    template <typename _Type, typename _Container, size_t _BitCnt>
+    inline constexpr lu_pivoting lu_pivoting_of<BigInt<_Type, _Container, _BitCnt>> = lu_pivoting::bareiss;
+    template <size_t _MOD, typename _V>
+    inline constexpr lu_pivoting lu_pivoting_of<ModInt<_MOD, _V>> = lu_pivoting::nonzero;
+    template <int _ID, typename _V>
+    inline constexpr lu_pivoting lu_pivoting_of<DynamicModInt<_ID, _V>> = lu_pivoting::nonzero;
+
+    // PA = LU for an H x W matrix, factored in place in the matrix it is given:
+    // U on and above the pivots, L's multipliers below them, rows exchanged
+    // whole. Columns without a pivot are skipped, so rank() holds for any shape;
+    // solve, determinant and inverse need a square matrix, and solve and
+    // inverse a nonsingular one.
+    //
+    // Field types factor in panels of NB columns: each panel is eliminated
+    // row by row, the rows of U to its right are finished by a triangular
+    // solve, and the rest of the matrix takes one multiply_add, which is gemm
+    // or the ModInt dot kernel. A floating-point pivot counts as zero up to
+    // max(H, W) * epsilon * max|a|. Bareiss types keep every entry a minor of
+    // the input: row i at step k becomes (a_kk * row_i - a_ik * row_k) / p for
+    // the previous pivot p, and a_ik stays in place to replay on right-hand sides.
+    // Built-in integers form those cross products at twice their width, so only
+    // the minors themselves have to fit.
     template <typename _T>
-    inline Matrix<_T> operator+(const Matrix<_T> &x, const Matrix<_T> &y)
+    class PLU
     {
-        if (!x.size())
-            return y;
-        if (!y.size())
+    public:
+        using element_type = _T;
+        static constexpr lu_pivoting pivoting = lu_pivoting_of<_T>;
+
+        explicit PLU(Matrix<element_type> a) : _lu(std::move(a)), _perm(_lu.getH())
+        {
+            for (size_t i = 0; i < _perm.size(); ++i)
+                _perm[i] = i;
+            if constexpr (pivoting == lu_pivoting::bareiss)
+                factor_bareiss();
+            else
+                factor_field();
+        }
+        inline size_t getH() const noexcept { return _lu.getH(); }
+        inline size_t getW() const noexcept { return _lu.getW(); }
+        inline size_t rank() const noexcept { return _cols.size(); }
+        // the packed factors, row i being row permutation()[i] of the input
+        inline const Matrix<element_type> &factors() const noexcept { return _lu; }
+        inline const std::vector<size_t> &permutation() const noexcept { return _perm; }
+        // the column of each pivot, in order
+        inline const std::vector<size_t> &pivots() const noexcept { return _cols; }
+
+        element_type determinant() const
+        {
+            size_t n = getH();
+            if (n != getW())
+                throw std::invalid_argument("invalid matrix size to compute determinant");
+            if (rank() < n)
+                return element_type(0);
+            element_type det = element_type(1);
+            if constexpr (pivoting == lu_pivoting::bareiss)
+                det = n ? _lu[n - 1][n - 1] : det;
+            else
+                for (size_t i = 0; i < n; ++i)
+                    det = det * _lu[i][i];
+            return _odd ? element_type(0) - det : det;
+        }
+        // X with AX = b. For Bareiss types X must be integral, or this throws
+        // std::domain_error; solve_scaled gives det(A) * X exactly in any case.
+        Matrix<element_type> solve(const Matrix<element_type> &b) const
+        {
+            Matrix<element_type> x = permuted(b);
+            if constexpr (pivoting == lu_pivoting::bareiss)
+            {
+                size_t n = getH();
+                for (auto &v : x)
+                {
+                    const element_type &d = _lu[n - 1][n - 1];
+                    if (!(v % d == element_type(0)))
+                        throw std::domain_error("solution is not integral");
+                    v = v / d;
+                }
+            }
             return x;
-        if (x.getH() != y.getH() || x.getW() != y.getW())
-            throw std::invalid_argument("invalid matrix size");
-        size_t _H = x.getH(), _W = x.getW();
-        Matrix<_T> res(_H, _W);
-        for (size_t i = 0; i < _H; ++i)
-            for (size_t j = 0; j < _W; ++j)
-                res[i][j] = x[i][j] + y[i][j];
-        return res;
-    }
-}
\ No newline at end of file
+        }
+        std::vector<element_type> solve(const std::vector<element_type> &b) const
+        {
+            Matrix<element_type> x = solve(column(b));
+            return std::vector<element_type>(x.begin(), x.end());
+        }
+        Matrix<element_type> solve_scaled(const Matrix<element_type> &b) const
+        {
+            Matrix<element_type> x = permuted(b);
+            if constexpr (pivoting == lu_pivoting::bareiss)
+            {
+                if (_odd)
+                    x *= element_type(0) - element_type(1);
+            }
+            else
+                x *= determinant();
+            return x;
+        }
+        std::vector<element_type> solve_scaled(const std::vector<element_type> &b) const
+        {
+            Matrix<element_type> x = solve_scaled(column(b));
+            return std::vector<element_type>(x.begin(), x.end());
+        }
+        Matrix<element_type> inverse() const
+        {
+            if (getH() != getW())
+                throw std::invalid_argument("invalid matrix size to compute inverse");
+            if (rank() < getH())
+                throw std::runtime_error("matrix is singular and cannot be inverted");
+            return solve(Matrix<element_type>::identity(getH()));
+        }
+
+    private:
+        static constexpr size_t NB = 64;
+        using wide_type = std::conditional_t<std::is_integral_v<element_type>, std::conditional_t<(sizeof(element_type) < sizeof(int64_t)), int64_t, __int128>, element_type>;
+        Matrix<element_type> _lu;
+        std::vector<size_t> _perm, _cols;
+        bool _odd = false;
+
+        static bool is_zero(const element_type &x) { return x == element_type(0); }
+        static auto magnitude(const element_type &x)
+        {
+            using std::abs;
+            return abs(x);
+        }
+        // x itself, or x in wide_type for built-in integers
+        static decltype(auto) widen(const element_type &x)
+        {
+            if constexpr (std::is_same_v<wide_type, element_type>)
+                return (x);
+            else
+                return wide_type(x);
+        }
+        // the Bareiss step (a * b - c * d) / p, exact
+        static element_type cross(const element_type &a, const element_type &b, const element_type &c, const element_type &d, const element_type &p)
+        {
+            return element_type((widen(a) * b - widen(c) * d) / p);
+        }
+        // row[j] -= c * src[j] for j in [from, to)
+        static void sub_row(typename Matrix<element_type>::iterator row, typename Matrix<element_type>::const_iterator src, const element_type &c, size_t from, size_t to)
+        {
+            for (size_t j = from; j < to; ++j)
+                row[j] = row[j] - c * src[j];
+        }
+        void swap_rows(size_t i, size_t j)
+        {
+            if (i == j)
+                return;
+            std::swap_ranges(_lu[i], _lu[i] + getW(), _lu[j]);
+            std::swap(_perm[i], _perm[j]);
+            _odd = !_odd;
+        }
+        void factor_field()
+        {
+            size_t H = getH(), W = getW(), r = 0;
+            auto tol = [&]()
+            {
+                if constexpr (pivoting == lu_pivoting::magnitude)
+                {
+                    auto t = magnitude(element_type(0));
+                    using real_type = decltype(t);
+                    for (auto &v : _lu)
+                        t = std::max(t, magnitude(v));
+                    return t * real_type(std::max(H, W)) * std::numeric_limits<real_type>::epsilon();
+                }
+                else
+                    return 0;
+            }();
+            for (size_t k0 = 0; k0 < W && r < H; k0 += NB)
+            {
+                size_t k1 = std::min(W, k0 + NB), r0 = r;
+                for (size_t c = k0; c < k1 && r < H; ++c)
+                {
+                    size_t p = H;
+                    if constexpr (pivoting == lu_pivoting::magnitude)
+                    {
+                        auto best = tol;
+                        for (size_t i = r; i < H; ++i)
+                            if (magnitude(_lu[i][c]) > best)
+                                best = magnitude(_lu[i][c]), p = i;
+                    }
+                    else
+                        for (size_t i = r; i < H && p == H; ++i)
+                            if (!is_zero(_lu[i][c]))
+                                p = i;
+                    if (p == H)
+                        continue;
+                    swap_rows(p, r);
+                    _cols.push_back(c);
+                    element_type inv = element_type(1) / _lu[r][c];
+                    for (size_t i = r + 1; i < H; ++i)
+                    {
+                        element_type l = _lu[i][c] = _lu[i][c] * inv;
+                        if (!is_zero(l))
+                            sub_row(_lu[i], _lu[r], l, c + 1, k1);
+                    }
+                    ++r;
+                }
+                size_t np = r - r0;
+                if (!np || k1 == W)
+                    continue;
+                // U12 = L11^-1 A12 on the panel's pivot rows
+                for (size_t a = 1; a < np; ++a)
+                    for (size_t b = 0; b < a; ++b)
+                        sub_row(_lu[r0 + a], _lu[r0 + b], _lu[r0 + a][_cols[r0 + b]], k1, W);
+                if (r == H)
+                    continue;
+                // A22 -= L21 U12
+                size_t M = H - r, N = W - k1;
+                Matrix<element_type> l21(M, np), u12(np, N), a22(M, N);
+                std::vector<element_type> scratch;
+                for (size_t i = 0; i < M; ++i)
+                {
+                    for (size_t b = 0; b < np; ++b)
+                        l21[i][b] = element_type(0) - _lu[r + i][_cols[r0 + b]];
+                    std::copy(_lu[r + i] + k1, _lu[r + i] + W, a22[i]);
+                }
+                for (size_t b = 0; b < np; ++b)
+                    std::copy(_lu[r0 + b] + k1, _lu[r0 + b] + W, u12[b]);
+                Matrix<element_type>::multiply_add(a22, l21, u12, scratch);
+                for (size_t i = 0; i < M; ++i)
+                    std::copy(a22[i], a22[i] + N, _lu[r + i] + k1);
+            }
+        }
+        void factor_bareiss()
+        {
+            size_t H = getH(), W = getW(), r = 0;
+            element_type prev = element_type(1);
+            for (size_t c = 0; c < W && r < H; ++c)
+            {
+                size_t p = r;
+                while (p < H && is_zero(_lu[p][c]))
+                    ++p;
+                if (p == H)
+                    continue;
+                swap_rows(p, r);
+                _cols.push_back(c);
+                const element_type &piv = _lu[r][c];
+                for (size_t i = r + 1; i < H; ++i)
+                {
+                    const element_type &l = _lu[i][c];
+                    for (size_t j = c + 1; j < W; ++j)
+                        _lu[i][j] = cross(_lu[i][j], piv, l, _lu[r][j], prev);
+                }
+                prev = piv;
+                ++r;
+            }
+        }
+        static Matrix<element_type> column(const std::vector<element_type> &b)
+        {
+            Matrix<element_type> x(b.size(), 1);
+            std::copy(b.begin(), b.end(), x.begin());
+            return x;
+        }
+        // P b carried through the factors: A^-1 b for field types, and for
+        // Bareiss types d * A^-1 b with d = det(PA), the last pivot
+        Matrix<element_type> permuted(const Matrix<element_type> &b) const
+        {
+            size_t n = getH(), m = b.getW();
+            if (n != getW())
+                throw std::invalid_argument("invalid matrix size to solve");
+            if (b.getH() != n)
+                throw std::invalid_argument("invalid matrix size");
+            if (rank() < n)
+                throw std::runtime_error("matrix is singular");
+            Matrix<element_type> x(n, m);
+            if (!n)
+                return x;
+            for (size_t i = 0; i < n; ++i)
+                std::copy(b[_perm[i]], b[_perm[i]] + m, x[i]);
+            if constexpr (pivoting == lu_pivoting::bareiss)
+            {
+                element_type prev = element_type(1);
+                for (size_t k = 0; k < n; ++k)
+                {
+                    const element_type &piv = _lu[k][k];
+                    for (size_t i = k + 1; i < n; ++i)
+                        for (size_t j = 0; j < m; ++j)
+                            x[i][j] = cross(x[i][j], piv, _lu[i][k], x[k][j], prev);
+                    prev = piv;
+                }
+                const element_type &d = _lu[n - 1][n - 1];
+                for (size_t i = n; i--;)
+                    for (size_t j = 0; j < m; ++j)
+                    {
+                        wide_type s = widen(d) * x[i][j];
+                        for (size_t t = i + 1; t < n; ++t)
+                            s = s - widen(_lu[i][t]) * x[t][j];
+                        x[i][j] = element_type(s / _lu[i][i]);
+                    }
+            }
+            else
+            {
+                // both substitutions in blocks of NB rows: row operations inside
+                // the diagonal block, one multiply_add for the rows beyond it
+                for (size_t k0 = 0; k0 < n; k0 += NB)
+                {
+                    size_t k1 = std::min(n, k0 + NB);
+                    for (size_t k = k0; k < k1; ++k)
+                        for (size_t i = k + 1; i < k1; ++i)
+                            if (!is_zero(_lu[i][k]))
+                                sub_row(x[i], x[k], _lu[i][k], 0, m);
+                    if (k1 < n)
+                        sub_block(x, k1, n, k0, k1);
+                }
+                for (size_t k1 = n; k1;)
+                {
+                    size_t k0 = k1 > NB ? k1 - NB : 0;
+                    for (size_t i = k1; i-- > k0;)
+                    {
+                        for (size_t t = i + 1; t < k1; ++t)
+                            if (!is_zero(_lu[i][t]))
+                                sub_row(x[i], x[t], _lu[i][t], 0, m);
+                        element_type inv = element_type(1) / _lu[i][i];
+                        for (size_t j = 0; j < m; ++j)
+                            x[i][j] = x[i][j] * inv;
+                    }
+                    if (k0)
+                        sub_block(x, 0, k0, k0, k1);
+                    k1 = k0;
+                }
+            }
+            return x;
+        }
+        // x's rows [a0, a1) -= the block of _lu at rows [a0, a1), columns
+        // [b0, b1), times x's rows [b0, b1)
+        void sub_block(Matrix<element_type> &x, size_t a0, size_t a1, size_t b0, size_t b1) const
+        {
+            size_t m = x.getW();
+            Matrix<element_type> c(a1 - a0, b1 - b0), y(b1 - b0, m), z(a1 - a0, m);
+            std::vector<element_type> scratch;
+            for (size_t i = a0; i < a1; ++i)
+            {
+                for (size_t t = b0; t < b1; ++t)
+                    c[i - a0][t - b0] = element_type(0) - _lu[i][t];
+                std::copy(x[i], x[i] + m, z[i - a0]);
+            }
+            for (size_t t = b0; t < b1; ++t)
+                std::copy(x[t], x[t] + m, y[t - b0]);
+            Matrix<element_type>::multiply_add(z, c, y, scratch);
+            for (size_t i = a0; i < a1; ++i)
+                std::copy(z[i - a0], z[i - a0] + m, x[i]);
+        }
+    };
+}
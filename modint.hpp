@@ -6,37 +6,419 @@
 #ifndef _MZLIB_MODINT_HPP
 #define _MZLIB_MODINT_HPP
 #endif
+#include <algorithm>
 #include <stdexcept>
 #include <stddef.h>
+#include <stdint.h>
+#include <type_traits>
+#include <vector>
+#include "simd.hpp"
+#if __cplusplus >= 202002L
+#include <compare>
+#endif
 
 namespace MZLIB
 {
+    template <typename _T>
+    inline _T modinv(_T a, size_t m);
+    template <typename _T>
+    class Poly;
+
+    // Residue modulo the compile-time _MOD; _T is the type values are built from
+    // and read back as. Residues take 32 bits below 2^32 and 64 bits above, with
+    // products widened to 64 or 128 bits, so any modulus up to 2^64 is exact.
+    // An odd modulus keeps values in Montgomery form (x*R mod _MOD, R = 2^32 or
+    // 2^64): a multiply is two widening multiplies and a conditional add, with
+    // no division. An even modulus keeps plain residues and reduces products by
+    // the constant: below 2^32 the compiler turns that into multiplies, above it
+    // the 128-bit remainder is a library division (__umodti3). Add and sub are
+    // branchless either way.
     template <size_t _MOD, typename _T = long>
     class ModInt
     {
+        static_assert(_MOD >= 1, "ModInt modulus must be positive");
+
     public:
         using value_type = _T;
+        using storage_type = std::conditional_t<(uint64_t(_MOD) >> 32) == 0, uint32_t, uint64_t>;
+        static constexpr storage_type mod = storage_type(_MOD);
+        static constexpr bool montgomery = _MOD % 2 == 1 && _MOD > 1;
+
         ModInt() : val(0) {}
-        ModInt(value_type _val) : val((_val + _MOD) % _MOD) {}
-        inline const value_type getval() const noexcept { return (val + _MOD) % _MOD; }
+        ModInt(value_type _val) : val(to_mont(reduce_in(_val))) {}
+        inline const value_type getval() const noexcept { return value_type(from_mont(val)); }
         inline operator value_type() const noexcept { return getval(); }
-        inline ModInt &operator+=(const ModInt &x) { return (*this) = (*this) + x; }
-        inline ModInt &operator-=(const ModInt &x) { return (*this) = (*this) - x; }
-        inline ModInt &operator*=(const ModInt &x) { return (*this) = (*this) * x; }
-        inline ModInt &operator/=(const ModInt &x) { return (*this) = (*this) / x; }
+        inline ModInt &operator+=(const ModInt &x) { return val = add(val, x.val), *this; }
+        inline ModInt &operator-=(const ModInt &x) { return val = sub(val, x.val), *this; }
+        inline ModInt &operator*=(const ModInt &x) { return val = mul(val, x.val), *this; }
+        inline ModInt &operator/=(const ModInt &x) { return (*this) *= x.inv(); }
+        inline ModInt operator-() const { return from_raw(sub(0, val)); }
+        inline ModInt pow(uint64_t e) const
+        {
+            ModInt r = from_raw(to_mont(1 % mod)), a = *this;
+            for (; e; e >>= 1, a *= a)
+                if (e & 1)
+                    r *= a;
+            return r;
+        }
+        // throws std::domain_error when gcd(x, _MOD) != 1
+        inline ModInt inv() const
+        {
+            using wide_signed = std::conditional_t<(uint64_t(_MOD) >> 62) == 0, long long, __int128>;
+            return from_raw(to_mont(storage_type(modinv<wide_signed>(from_mont(val), _MOD))));
+        }
 
         inline friend bool operator==(const ModInt &x, const ModInt &y) { return x.val == y.val; }
 #if __cplusplus >= 202002L
-        inline friend bool operator<=>(const ModInt &x, const ModInt &y) { return x.val <=> y.val; }
+        inline friend auto operator<=>(const ModInt &x, const ModInt &y) { return from_mont(x.val) <=> from_mont(y.val); }
 #else
         inline friend bool operator!=(const ModInt &x, const ModInt &y) { return x.val != y.val; }
-        inline friend bool operator<(const ModInt &x, const ModInt &y) { return x.val < y.val; }
-        inline friend bool operator>(const ModInt &x, const ModInt &y) { return x.val > y.val; }
-        inline friend bool operator<=(const ModInt &x, const ModInt &y) { return x.val <= y.val; }
-        inline friend bool operator>=(const ModInt &x, const ModInt &y) { return x.val >= y.val; }
+        inline friend bool operator<(const ModInt &x, const ModInt &y) { return from_mont(x.val) < from_mont(y.val); }
+        inline friend bool operator>(const ModInt &x, const ModInt &y) { return from_mont(x.val) > from_mont(y.val); }
+        inline friend bool operator<=(const ModInt &x, const ModInt &y) { return from_mont(x.val) <= from_mont(y.val); }
+        inline friend bool operator>=(const ModInt &x, const ModInt &y) { return from_mont(x.val) >= from_mont(y.val); }
 #endif
+
+        // Element-wise r[i] = a[i] op b[i] over n residues; r may alias a or b.
+        // Moduli below 2^31 run eight or sixteen lanes at a time on AVX2 or
+        // AVX-512 (products only when the modulus is odd), the rest a scalar loop.
+        inline friend void vec_add(ModInt *r, const ModInt *a, const ModInt *b, size_t n) { lanes<0>(raw(r), raw(a), raw(b), n); }
+        inline friend void vec_sub(ModInt *r, const ModInt *a, const ModInt *b, size_t n) { lanes<1>(raw(r), raw(a), raw(b), n); }
+        inline friend void vec_mul(ModInt *r, const ModInt *a, const ModInt *b, size_t n) { lanes<2>(raw(r), raw(a), raw(b), n); }
+        // sum of a[i]*b[i]; 32-bit residues are summed unreduced in 128 bits and
+        // divided once
+        inline friend ModInt vec_dot(const ModInt *a, const ModInt *b, size_t n) { return from_raw(dot(raw(a), raw(b), n)); }
+        // Replaces a[0, n) by their inverses with a single modinv (Montgomery's
+        // trick): prefix products are taken in eight interleaved chains so the
+        // multiplies pipeline and vectorize, the eight chain totals are inverted
+        // together, and a backward pass peels off each element. Throws
+        // std::domain_error, leaving a unchanged, if any a[i] is not invertible.
+        inline friend void batch_inverse(ModInt *a, size_t n) { batch_inv(raw(a), n); }
+
+        inline friend std::vector<ModInt> vec_add(const std::vector<ModInt> &a, const std::vector<ModInt> &b) { return lanes_vec<0>(a, b); }
+        inline friend std::vector<ModInt> vec_sub(const std::vector<ModInt> &a, const std::vector<ModInt> &b) { return lanes_vec<1>(a, b); }
+        inline friend std::vector<ModInt> vec_mul(const std::vector<ModInt> &a, const std::vector<ModInt> &b) { return lanes_vec<2>(a, b); }
+        inline friend ModInt vec_dot(const std::vector<ModInt> &a, const std::vector<ModInt> &b)
+        {
+            if (a.size() != b.size())
+                throw std::invalid_argument("vector sizes do not match");
+            return vec_dot(a.data(), b.data(), a.size());
+        }
+        inline friend void batch_inverse(std::vector<ModInt> &a) { batch_inverse(a.data(), a.size()); }
+
     private:
-        value_type val;
+        template <typename>
+        friend class Poly;
+        using wide_type = std::conditional_t<std::is_same_v<storage_type, uint32_t>, uint64_t, unsigned __int128>;
+        static constexpr int bits = sizeof(storage_type) * 8;
+        // _MOD^(-1) mod R by Newton's iteration, each step doubling the correct bits
+        static constexpr storage_type ninv = []()
+        {
+            storage_type x = mod;
+            for (int i = 0; i < 6; ++i)
+                x *= storage_type(2) - mod * x;
+            return x;
+        }();
+        // R^2 mod _MOD
+        static constexpr storage_type r2 = []()
+        {
+            wide_type r = (wide_type(1) << bits) % mod;
+            return storage_type(r * r % mod);
+        }();
+        storage_type val;
+
+        static ModInt from_raw(storage_type v)
+        {
+            ModInt r;
+            r.val = v;
+            return r;
+        }
+        template <typename _V>
+        static storage_type reduce_in(_V v)
+        {
+            if constexpr (std::is_signed_v<_V>)
+                if (v < 0)
+                {
+                    uint64_t u = (uint64_t(0) - uint64_t(v)) % _MOD;
+                    return storage_type(u ? _MOD - u : 0);
+                }
+            return storage_type(uint64_t(v) % _MOD);
+        }
+        static storage_type add(storage_type a, storage_type b)
+        {
+            storage_type d = a - (mod - b);
+            return d + (mod & (storage_type(0) - storage_type(a < mod - b)));
+        }
+        static storage_type sub(storage_type a, storage_type b)
+        {
+            storage_type d = a - b;
+            return d + (mod & (storage_type(0) - storage_type(a < b)));
+        }
+        // t*R^(-1) mod _MOD for t < _MOD*R: t and q*_MOD (q = t*_MOD^(-1) mod R)
+        // agree in the low word, so their difference over R is the difference of
+        // the high words, which lies in (-_MOD, _MOD).
+        static storage_type redc(wide_type t)
+        {
+            storage_type q = storage_type(t) * ninv;
+            storage_type h = storage_type(t >> bits), s = storage_type((wide_type(q) * mod) >> bits);
+            return storage_type(h - s) + (mod & (storage_type(0) - storage_type(h < s)));
+        }
+        static storage_type mul(storage_type a, storage_type b)
+        {
+            if constexpr (montgomery)
+                return redc(wide_type(a) * b);
+            else
+                return storage_type(wide_type(a) * b % mod);
+        }
+        static storage_type to_mont(storage_type x)
+        {
+            if constexpr (montgomery)
+                return mul(x, r2);
+            else
+                return x;
+        }
+        static storage_type from_mont(storage_type x)
+        {
+            if constexpr (montgomery)
+                return redc(x);
+            else
+                return x;
+        }
+        // The span functions work on the stored words directly.
+        static constexpr bool lanes32 = std::is_same_v<storage_type, uint32_t> && (_MOD >> 31) == 0;
+        static constexpr size_t chains = 8;
+        static storage_type *raw(ModInt *x)
+        {
+            static_assert(sizeof(ModInt) == sizeof(storage_type), "ModInt must be a bare word");
+            return reinterpret_cast<storage_type *>(x);
+        }
+        static const storage_type *raw(const ModInt *x) { return reinterpret_cast<const storage_type *>(x); }
+        template <int _Op>
+        static storage_type apply(storage_type a, storage_type b) { return _Op == 0 ? add(a, b) : _Op == 1 ? sub(a, b) : mul(a, b); }
+        template <int _Op>
+        static void lanes_scalar(storage_type *r, const storage_type *a, const storage_type *b, size_t n)
+        {
+            for (size_t i = 0; i < n; ++i)
+                r[i] = apply<_Op>(a[i], b[i]);
+        }
+#if MZLIB_SIMD_X86
+        // -_MOD^(-1) mod 2^32, as mont_mul_x8 expects
+        static constexpr storage_type nminv = storage_type(0) - ninv;
+        template <int _Op>
+        MZLIB_TARGET_AVX2 static void lanes_avx2(storage_type *r, const storage_type *a, const storage_type *b, size_t n)
+        {
+            const __m256i m = _mm256_set1_epi32(int(mod)), mi = _mm256_set1_epi32(int(nminv));
+            size_t i = 0;
+            for (; i + 8 <= n; i += 8)
+            {
+                __m256i x = _mm256_loadu_si256((const __m256i *)(a + i)), y = _mm256_loadu_si256((const __m256i *)(b + i));
+                x = _Op == 0 ? add_mod_x8(x, y, m) : _Op == 1 ? sub_mod_x8(x, y, m) : mont_mul_x8(x, y, m, mi);
+                _mm256_storeu_si256((__m256i *)(r + i), x);
+            }
+            lanes_scalar<_Op>(r + i, a + i, b + i, n - i);
+        }
+        template <int _Op>
+        MZLIB_TARGET_AVX512 static void lanes_avx512(storage_type *r, const storage_type *a, const storage_type *b, size_t n)
+        {
+            const __m512i m = _mm512_set1_epi32(int(mod)), mi = _mm512_set1_epi32(int(nminv));
+            size_t i = 0;
+            for (; i + 16 <= n; i += 16)
+            {
+                __m512i x = _mm512_loadu_si512(a + i), y = _mm512_loadu_si512(b + i);
+                x = _Op == 0 ? add_mod_x16(x, y, m) : _Op == 1 ? sub_mod_x16(x, y, m) : mont_mul_x16(x, y, m, mi);
+                _mm512_storeu_si512(r + i, x);
+            }
+            lanes_scalar<_Op>(r + i, a + i, b + i, n - i);
+        }
+#endif
+        // isa caps the lane width: the prefix chains of batch_inv read back
+        // results written eight words earlier, so they must not go wider
+        template <int _Op>
+        static void lanes(storage_type *r, const storage_type *a, const storage_type *b, size_t n, simd_isa isa = simd_level())
+        {
+#if MZLIB_SIMD_X86
+            if constexpr (lanes32 && (_Op != 2 || montgomery))
+                switch (isa)
+                {
+                case simd_isa::avx512:
+                    return lanes_avx512<_Op>(r, a, b, n);
+                case simd_isa::avx2:
+                    return lanes_avx2<_Op>(r, a, b, n);
+                default:
+                    break;
+                }
+#endif
+            (void)isa;
+            lanes_scalar<_Op>(r, a, b, n);
+        }
+        template <int _Op>
+        static std::vector<ModInt> lanes_vec(const std::vector<ModInt> &a, const std::vector<ModInt> &b)
+        {
+            if (a.size() != b.size())
+                throw std::invalid_argument("vector sizes do not match");
+            std::vector<ModInt> r(a.size());
+            lanes<_Op>(raw(r.data()), raw(a.data()), raw(b.data()), a.size());
+            return r;
+        }
+        static storage_type dot(const storage_type *a, const storage_type *b, size_t n)
+        {
+            if constexpr (std::is_same_v<storage_type, uint32_t>)
+            {
+                // each product is below 2^64, so the sum fits for any n
+                unsigned __int128 s = 0;
+                for (size_t i = 0; i < n; ++i)
+                    s += uint64_t(a[i]) * b[i];
+                // s = x*y*R^2 summed, or x*y plainly; one reduction leaves R^1
+                storage_type t = storage_type(s % mod);
+                return montgomery ? redc(t) : t;
+            }
+            else
+            {
+                storage_type s = 0;
+                for (size_t i = 0; i < n; ++i)
+                    s = add(s, mul(a[i], b[i]));
+                return s;
+            }
+        }
+        static void batch_inv(storage_type *a, size_t n)
+        {
+            if (!n)
+                return;
+            // p[i] = a[i] * p[i - chains], the product of a's entries congruent to i
+            std::vector<storage_type> p(n);
+            size_t h = std::min(n, chains);
+            std::copy(a, a + h, p.begin());
+            if (n > chains)
+                lanes<2>(p.data() + chains, p.data(), a + chains, n - chains, std::min(simd_level(), simd_isa::avx2));
+            storage_type one = to_mont(1 % mod), tot[chains], pre[chains], inv[chains];
+            storage_type all = one;
+            for (size_t j = 0; j < chains; ++j)
+            {
+                tot[j] = j < n ? p[j + (n - 1 - j) / chains * chains] : one;
+                pre[j] = all, all = mul(all, tot[j]);
+            }
+            all = from_raw(all).inv().val;
+            for (size_t j = chains; j-- > 0;)
+                inv[j] = mul(all, pre[j]), all = mul(all, tot[j]);
+            // walking down, inv[i % chains] is the inverse of p[i]
+            size_t i = n;
+            for (; i > chains && i % chains; --i)
+            {
+                storage_type &c = inv[(i - 1) % chains];
+                storage_type r = mul(c, p[i - 1 - chains]);
+                c = mul(c, a[i - 1]), a[i - 1] = r;
+            }
+            for (; i > chains; i -= chains)
+            {
+                storage_type *x = a + i - chains;
+                const storage_type *q = p.data() + i - 2 * chains;
+                storage_type r[chains];
+                lanes<2>(r, inv, q, chains, std::min(simd_level(), simd_isa::avx2));
+                lanes<2>(inv, inv, x, chains, std::min(simd_level(), simd_isa::avx2));
+                std::copy(r, r + chains, x);
+            }
+            std::copy(inv, inv + i, a);
+        }
+    };
+    // Residue modulo a modulus set at run time with set_mod, shared by every
+    // DynamicModInt with the same _ID (998244353 until set). Values are plain
+    // residues; products are reduced by Barrett's method against constants
+    // computed in set_mod, so no division is issued afterwards. Moduli below
+    // 2^31 take a one-multiply path, larger ones up to 2^63 a 128-bit one.
+    template <int _ID = 0, typename _T = long>
+    class DynamicModInt
+    {
+    public:
+        using value_type = _T;
+        static void set_mod(uint64_t m)
+        {
+            if (m == 0 || (m >> 63))
+                throw std::invalid_argument("DynamicModInt modulus must be in [1, 2^63)");
+            _mod = m, _im = ~uint64_t(0) / m + 1, _mu = ~(unsigned __int128)0 / m;
+        }
+        static uint64_t mod() { return _mod; }
+
+        DynamicModInt() : val(0) {}
+        DynamicModInt(value_type _val)
+        {
+            if constexpr (std::is_signed_v<value_type>)
+                if (_val < 0)
+                {
+                    uint64_t u = (uint64_t(0) - uint64_t(_val)) % _mod;
+                    val = u ? _mod - u : 0;
+                    return;
+                }
+            val = uint64_t(_val) % _mod;
+        }
+        inline const value_type getval() const noexcept { return value_type(val); }
+        inline operator value_type() const noexcept { return getval(); }
+        inline DynamicModInt &operator+=(const DynamicModInt &x)
+        {
+            uint64_t d = val - (_mod - x.val);
+            return val = d + (_mod & (uint64_t(0) - uint64_t(val < _mod - x.val))), *this;
+        }
+        inline DynamicModInt &operator-=(const DynamicModInt &x)
+        {
+            uint64_t d = val - x.val;
+            return val = d + (_mod & (uint64_t(0) - uint64_t(val < x.val))), *this;
+        }
+        inline DynamicModInt &operator*=(const DynamicModInt &x) { return val = mul(val, x.val), *this; }
+        inline DynamicModInt &operator/=(const DynamicModInt &x) { return (*this) *= x.inv(); }
+        inline DynamicModInt operator-() const { return DynamicModInt() -= *this; }
+        inline DynamicModInt pow(uint64_t e) const
+        {
+            DynamicModInt r(1), a = *this;
+            for (; e; e >>= 1, a *= a)
+                if (e & 1)
+                    r *= a;
+            return r;
+        }
+        // throws std::domain_error when gcd(x, mod()) != 1
+        inline DynamicModInt inv() const
+        {
+            DynamicModInt r;
+            r.val = uint64_t(modinv<long long>((long long)val, _mod));
+            return r;
+        }
+
+        inline friend DynamicModInt operator+(DynamicModInt x, const DynamicModInt &y) { return x += y; }
+        inline friend DynamicModInt operator-(DynamicModInt x, const DynamicModInt &y) { return x -= y; }
+        inline friend DynamicModInt operator*(DynamicModInt x, const DynamicModInt &y) { return x *= y; }
+        inline friend DynamicModInt operator/(DynamicModInt x, const DynamicModInt &y) { return x /= y; }
+        inline friend bool operator==(const DynamicModInt &x, const DynamicModInt &y) { return x.val == y.val; }
+#if __cplusplus >= 202002L
+        inline friend auto operator<=>(const DynamicModInt &x, const DynamicModInt &y) { return x.val <=> y.val; }
+#else
+        inline friend bool operator!=(const DynamicModInt &x, const DynamicModInt &y) { return x.val != y.val; }
+        inline friend bool operator<(const DynamicModInt &x, const DynamicModInt &y) { return x.val < y.val; }
+        inline friend bool operator>(const DynamicModInt &x, const DynamicModInt &y) { return x.val > y.val; }
+        inline friend bool operator<=(const DynamicModInt &x, const DynamicModInt &y) { return x.val <= y.val; }
+        inline friend bool operator>=(const DynamicModInt &x, const DynamicModInt &y) { return x.val >= y.val; }
+#endif
+    private:
+        static inline uint64_t _mod = 998244353, _im = ~uint64_t(0) / 998244353 + 1;
+        static inline unsigned __int128 _mu = ~(unsigned __int128)0 / 998244353;
+        uint64_t val;
+
+        // a*b mod m for a, b < m. Below 2^31, z = a*b < 2^62 and the estimate
+        // hi(z*ceil(2^64/m)) is z/m or one more. Above, q = hi(z*floor((2^128-1)/m))
+        // is at most two below z/m.
+        static uint64_t mul(uint64_t a, uint64_t b)
+        {
+            if (!(_mod >> 31))
+            {
+                uint64_t z = a * b, x = uint64_t(((unsigned __int128)z * _im) >> 64), y = x * _mod;
+                return z - y + (z < y ? _mod : 0);
+            }
+            unsigned __int128 z = (unsigned __int128)a * b;
+            uint64_t zl = uint64_t(z), zh = uint64_t(z >> 64), ml = uint64_t(_mu), mh = uint64_t(_mu >> 64);
+            unsigned __int128 ll = (unsigned __int128)zl * ml, lh = (unsigned __int128)zl * mh, hl = (unsigned __int128)zh * ml;
+            unsigned __int128 mid = (ll >> 64) + uint64_t(lh) + uint64_t(hl);
+            unsigned __int128 q = (unsigned __int128)zh * mh + (lh >> 64) + (hl >> 64) + (mid >> 64);
+            unsigned __int128 r = z - q * _mod;
+            r -= r >= _mod ? _mod : 0;
+            return uint64_t(r >= _mod ? r - _mod : r);
+        }
     };
     template <typename _T>
     inline _T modinv(_T a, size_t m)
@@ -44,7 +426,7 @@ namespace MZLIB
         if (m == 1)
             return 0;
         _T m0 = m, t, q, x0 = 0, x1 = 1;
-        while (a > 1)
+        while (a > 1 && m)
         {
             q = a / m;
             t = m;
@@ -61,22 +443,22 @@ namespace MZLIB
     template <size_t _MOD, typename _T>
     inline ModInt<_MOD, _T> operator+(const ModInt<_MOD, _T> &x, const ModInt<_MOD, _T> &y)
     {
-        return ModInt<_MOD, _T>((x.getval() + y.getval()) % _MOD);
+        return ModInt<_MOD, _T>(x) += y;
     }
     template <size_t _MOD, typename _T>
     inline ModInt<_MOD, _T> operator-(const ModInt<_MOD, _T> &x, const ModInt<_MOD, _T> &y)
     {
-        return ModInt<_MOD, _T>((x.getval() - y.getval() + _MOD) % _MOD);
+        return ModInt<_MOD, _T>(x) -= y;
     }
     template <size_t _MOD, typename _T>
     inline ModInt<_MOD, _T> operator*(const ModInt<_MOD, _T> &x, const ModInt<_MOD, _T> &y)
     {
-        return ModInt<_MOD, _T>((x.getval() * y.getval()) % _MOD);
+        return ModInt<_MOD, _T>(x) *= y;
     }
     template <size_t _MOD, typename _T>
     inline ModInt<_MOD, _T> operator/(const ModInt<_MOD, _T> &x, const ModInt<_MOD, _T> &y)
     {
-        return ModInt<_MOD, _T>((x.getval() * modinv(y.getval(), _MOD)) % _MOD);
+        return ModInt<_MOD, _T>(x) /= y;
     }
 
-}
\ No newline at end of file
+}
@@ -0,0 +1,497 @@
+// FileName : poly.hpp
+// Polynomial Packed Class Header
+// Programmed By MightZero
+// Copyright (c) 2025-2026 MightZero
+#pragma once
+#ifndef _MZLIB_POLY_HPP
+#define _MZLIB_POLY_HPP
+#endif
+#include <algorithm>
+#include <initializer_list>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+#include "bigint.hpp"
+#include "modint.hpp"
+
+namespace MZLIB
+{
+    // Smallest primitive root of the prime p, found by trial division of p - 1.
+    inline constexpr uint32_t primitive_root(uint32_t p)
+    {
+        uint32_t f[32] = {}, k = 0, n = p - 1;
+        for (uint32_t d = 2; uint64_t(d) * d <= n; ++d)
+            if (n % d == 0)
+                for (f[k++] = d; n % d == 0;)
+                    n /= d;
+        if (n > 1)
+            f[k++] = n;
+        for (uint32_t g = 2;; ++g)
+        {
+            bool ok = true;
+            for (uint32_t i = 0; ok && i < k; ++i)
+            {
+                uint64_t r = 1, b = g;
+                for (uint32_t e = (p - 1) / f[i]; e; e >>= 1, b = b * b % p)
+                    if (e & 1)
+                        r = r * b % p;
+                ok = r != 1;
+            }
+            if (ok)
+                return g;
+        }
+    }
+
+    // convolve_mod on ModInt data, for any modulus below 2^32
+    template <size_t _MOD, typename _V>
+    inline std::vector<ModInt<_MOD, _V>> convolve_mod(const std::vector<ModInt<_MOD, _V>> &a, const std::vector<ModInt<_MOD, _V>> &b)
+    {
+        static_assert((uint64_t(_MOD) >> 32) == 0, "convolve_mod needs a modulus below 2^32");
+        auto plain = [](const std::vector<ModInt<_MOD, _V>> &x)
+        {
+            std::vector<uint32_t> r(x.size());
+            for (size_t i = 0; i < x.size(); ++i)
+                r[i] = uint32_t(x[i].getval());
+            return r;
+        };
+        std::vector<uint32_t> x = plain(a), c = &a == &b ? convolve_mod(x, x, uint32_t(_MOD)) : convolve_mod(x, plain(b), uint32_t(_MOD));
+        std::vector<ModInt<_MOD, _V>> r(c.size());
+        for (size_t i = 0; i < c.size(); ++i)
+            r[i] = ModInt<_MOD, _V>(_V(c[i]));
+        return r;
+    }
+
+    template <typename _T>
+    class Poly;
+    // Polynomial with coefficients in ModInt<_MOD>, lowest degree first, for a
+    // prime _MOD below 2^31 with _MOD - 1 divisible by a large power of two
+    // (998244353 by default). Products go through NTT<_MOD>, the same tables
+    // BigInt uses for that prime. ModInt stores its words in the transform's
+    // Montgomery form, so coefficients are transformed where they lie, and the
+    // Newton iterations keep operands in the transformed domain between the
+    // products of a step. Sizes are not trimmed: a product of sizes n and m has
+    // size n + m - 1, and the series functions take the number of terms wanted.
+    template <size_t _MOD, typename _V>
+    class Poly<ModInt<_MOD, _V>>
+    {
+    public:
+        using element_type = ModInt<_MOD, _V>;
+        using reference = element_type &;
+        using const_reference = const element_type &;
+        using iterator = typename std::vector<element_type>::iterator;
+        using const_iterator = typename std::vector<element_type>::const_iterator;
+        using ntt_type = NTT<uint32_t(_MOD), primitive_root(uint32_t(_MOD)), size_t(__builtin_ctzll(_MOD - 1))>;
+        static_assert(element_type::montgomery && (_MOD >> 31) == 0, "Poly needs an odd prime modulus below 2^31");
+
+        Poly() = default;
+        explicit Poly(size_t n, const element_type &x = element_type()) : _dat(n, x) {}
+        Poly(std::initializer_list<element_type> _ls) : _dat(_ls) {}
+        explicit Poly(std::vector<element_type> _val) : _dat(std::move(_val)) {}
+
+        inline size_t size() const noexcept { return _dat.size(); }
+        inline bool empty() const noexcept { return _dat.empty(); }
+        inline reference operator[](size_t i) { return _dat[i]; }
+        inline const_reference operator[](size_t i) const { return _dat[i]; }
+        inline iterator begin() noexcept { return _dat.begin(); }
+        inline iterator end() noexcept { return _dat.end(); }
+        inline const_iterator begin() const noexcept { return _dat.begin(); }
+        inline const_iterator end() const noexcept { return _dat.end(); }
+        inline const std::vector<element_type> &data() const noexcept { return _dat; }
+        inline void resize(size_t n) { _dat.resize(n); }
+        // drops trailing zero coefficients
+        inline Poly &shrink()
+        {
+            while (!_dat.empty() && _dat.back() == element_type())
+                _dat.pop_back();
+            return *this;
+        }
+        // this mod x^n, padded with zeros to n terms
+        inline Poly truncated(size_t n) const
+        {
+            Poly r;
+            r._dat.assign(_dat.begin(), _dat.begin() + std::min(n, size()));
+            r._dat.resize(n);
+            return r;
+        }
+        inline element_type eval(const element_type &x) const
+        {
+            element_type r;
+            for (size_t i = size(); i-- > 0;)
+                r = r * x + _dat[i];
+            return r;
+        }
+
+        Poly &operator+=(const Poly &x)
+        {
+            if (x.size() > size())
+                _dat.resize(x.size());
+            for (size_t i = 0; i < x.size(); ++i)
+                _dat[i] += x._dat[i];
+            return *this;
+        }
+        Poly &operator-=(const Poly &x)
+        {
+            if (x.size() > size())
+                _dat.resize(x.size());
+            for (size_t i = 0; i < x.size(); ++i)
+                _dat[i] -= x._dat[i];
+            return *this;
+        }
+        Poly &operator*=(const Poly &x) { return _dat = multiply(_dat, x._dat), *this; }
+        Poly &operator*=(const element_type &x)
+        {
+            for (auto &c : _dat)
+                c *= x;
+            return *this;
+        }
+        Poly operator-() const
+        {
+            Poly r(*this);
+            for (auto &c : r._dat)
+                c = -c;
+            return r;
+        }
+        inline friend Poly operator+(Poly x, const Poly &y) { return x += y; }
+        inline friend Poly operator-(Poly x, const Poly &y) { return x -= y; }
+        inline friend Poly operator*(const Poly &x, const Poly &y) { return Poly(multiply(x._dat, y._dat)); }
+        inline friend Poly operator*(Poly x, const element_type &y) { return x *= y; }
+        inline friend Poly operator*(const element_type &x, Poly y) { return y *= x; }
+        inline friend bool operator==(const Poly &x, const Poly &y) { return x._dat == y._dat; }
+        inline friend bool operator!=(const Poly &x, const Poly &y) { return x._dat != y._dat; }
+
+        // (q, r) with x = q*y + r and deg r < deg y, both shrunk; the quotient
+        // comes from the reversed operands and a power series inverse
+        inline friend std::pair<Poly, Poly> divmod(const Poly &x, const Poly &y)
+        {
+            Poly a(x), b(y);
+            a.shrink(), b.shrink();
+            if (b.empty())
+                throw std::invalid_argument("divisor cannot be zero");
+            if (a.size() < b.size())
+                return {Poly(), std::move(a)};
+            size_t n = a.size(), m = b.size(), k = n - m + 1;
+            Poly q(k);
+            if (std::min(k, m) <= DIV_NAIVE_THRESHOLD)
+            {
+                element_type li = b._dat.back().inv();
+                for (size_t i = k; i-- > 0;)
+                {
+                    element_type c = a._dat[i + m - 1] * li;
+                    q._dat[i] = c;
+                    for (size_t j = 0; j < m; ++j)
+                        a._dat[i + j] -= c * b._dat[j];
+                }
+                a.resize(m - 1);
+                return {std::move(q.shrink()), std::move(a.shrink())};
+            }
+            Poly ra(std::vector<element_type>(a._dat.rbegin(), a._dat.rbegin() + k));
+            Poly rb(std::vector<element_type>(b._dat.rbegin(), b._dat.rend()));
+            q = (ra * rb.inv(k)).truncated(k);
+            std::reverse(q._dat.begin(), q._dat.end());
+            a -= (b * q).truncated(m - 1);
+            a.resize(m - 1);
+            return {std::move(q.shrink()), std::move(a.shrink())};
+        }
+        inline friend Poly operator/(const Poly &x, const Poly &y) { return divmod(x, y).first; }
+        inline friend Poly operator%(const Poly &x, const Poly &y) { return divmod(x, y).second; }
+
+        Poly derivative() const
+        {
+            Poly r(size() ? size() - 1 : 0);
+            for (size_t i = 1; i < size(); ++i)
+                r._dat[i - 1] = _dat[i] * element_type(typename element_type::value_type(i));
+            return r;
+        }
+        // antiderivative with zero constant term
+        Poly integral() const
+        {
+            std::vector<element_type> iv = inverses(size() + 1);
+            Poly r(size() + 1);
+            for (size_t i = 0; i < size(); ++i)
+                r._dat[i + 1] = _dat[i] * iv[i + 1];
+            return r;
+        }
+        // 1/this mod x^n; throws std::domain_error when the constant term is zero.
+        // Each doubling step takes f*g mod x^(2m) - 1, whose top half is exact,
+        // and multiplies that half by g again with g's spectrum reused.
+        Poly inv(size_t n) const
+        {
+            if (empty())
+                throw std::domain_error("inverse does not exist");
+            std::vector<element_type> g{_dat[0].inv()}, F, G;
+            for (size_t m = 1; m < n; m *= 2)
+            {
+                size_t L = 2 * m;
+                F.assign(_dat.begin(), _dat.begin() + std::min(L, size()));
+                G = g;
+                dft(F, L), dft(G, L);
+                pointwise(F, G), idft(F);
+                std::fill(F.begin(), F.begin() + m, element_type());
+                dft(F, L), pointwise(F, G), idft(F);
+                g.resize(L);
+                for (size_t i = m; i < L; ++i)
+                    g[i] = -F[i];
+            }
+            g.resize(n);
+            return Poly(std::move(g));
+        }
+        // ln(this) mod x^n for a constant term of 1
+        Poly log(size_t n) const
+        {
+            if (empty() || _dat[0] != element_type(1))
+                throw std::invalid_argument("log needs a constant term of 1");
+            if (!n)
+                return Poly();
+            Poly d = truncated(n).derivative() * inv(n);
+            d.resize(n - 1);
+            return d.integral();
+        }
+        // exp(this) mod x^n for a constant term of 0, by g <- g*(1 - ln g + this)
+        Poly exp(size_t n) const
+        {
+            if (!empty() && _dat[0] != element_type())
+                throw std::invalid_argument("exp needs a constant term of 0");
+            if (!n)
+                return Poly();
+            Poly g{element_type(1)};
+            for (size_t m = 1; m < n; m *= 2)
+            {
+                size_t L = 2 * m;
+                Poly h = truncated(L) - g.log(L);
+                h._dat[0] += element_type(1);
+                g = (g * h).truncated(L);
+            }
+            return g.truncated(n);
+        }
+        // A square root mod x^n, by g <- (g + this/g)/2; throws std::domain_error
+        // when there is none (lowest term of odd degree or a non-residue)
+        Poly sqrt(size_t n) const
+        {
+            size_t k = 0;
+            while (k < size() && _dat[k] == element_type())
+                ++k;
+            if (k == size() || k >= n)
+                return Poly(n);
+            if (k % 2)
+                throw std::domain_error("square root does not exist");
+            size_t t = n - k / 2;
+            element_type c = _dat[k], ci = c.inv(), half = element_type(2).inv();
+            Poly f = shifted_down(k, t) * ci, g{element_type(1)};
+            for (size_t m = 1; m < t; m *= 2)
+            {
+                size_t L = 2 * m;
+                g = ((g + (f.truncated(L) * g.inv(L)).truncated(L)) * half);
+            }
+            g = g.truncated(t) * sqrt_mod(c);
+            g._dat.insert(g._dat.begin(), k / 2, element_type());
+            return g;
+        }
+        // this^e mod x^n, through exp(e*ln) once the lowest term is divided out
+        Poly pow(uint64_t e, size_t n) const
+        {
+            Poly r(n);
+            if (!e)
+            {
+                if (n)
+                    r._dat[0] = element_type(1);
+                return r;
+            }
+            size_t k = 0;
+            while (k < size() && _dat[k] == element_type())
+                ++k;
+            if (k == size() || !n || (k && e > (n - 1) / k))
+                return r;
+            size_t s = k * e, t = n - s;
+            element_type c = _dat[k];
+            Poly f = shifted_down(k, t) * c.inv();
+            // (1 + h)^_MOD = 1 mod x^t as t <= _MOD, so e only matters mod _MOD here
+            f = (f.log(t) * element_type(typename element_type::value_type(e % _MOD))).exp(t) * c.pow(e);
+            std::copy(f._dat.begin(), f._dat.end(), r._dat.begin() + s);
+            return r;
+        }
+
+        // this at every point of xs, by remainders down a subproduct tree
+        std::vector<element_type> evaluate(const std::vector<element_type> &xs) const
+        {
+            std::vector<element_type> ys(xs.size());
+            if (xs.empty())
+                return ys;
+            std::vector<Poly> tree(4 * xs.size());
+            build_tree(tree, 1, 0, xs.size(), xs);
+            eval_down(tree, 1, 0, xs.size(), *this % tree[1], xs, ys);
+            return ys;
+        }
+        // The polynomial of size xs.size() through (xs[i], ys[i]); throws
+        // std::domain_error when two points coincide
+        static Poly interpolate(const std::vector<element_type> &xs, const std::vector<element_type> &ys)
+        {
+            if (xs.size() != ys.size())
+                throw std::invalid_argument("point and value counts differ");
+            if (xs.empty())
+                return Poly();
+            size_t n = xs.size();
+            std::vector<Poly> tree(4 * n);
+            build_tree(tree, 1, 0, n, xs);
+            std::vector<element_type> w(n);
+            eval_down(tree, 1, 0, n, tree[1].derivative(), xs, w);
+            batch_inverse(w);
+            for (size_t i = 0; i < n; ++i)
+                w[i] *= ys[i];
+            Poly r = interp_up(tree, 1, 0, n, xs, w);
+            r.resize(n);
+            return r;
+        }
+
+    private:
+        // Below these sizes products, divisions and tree nodes are done directly.
+        static constexpr size_t MUL_NAIVE_THRESHOLD = 32;
+        static constexpr size_t DIV_NAIVE_THRESHOLD = 64;
+        static constexpr size_t TREE_LEAF = 64;
+        std::vector<element_type> _dat;
+
+        static uint32_t *raw(element_type *x) { return element_type::raw(x); }
+        // a zero-padded to n (a power of two) and transformed in place; the
+        // spectrum is bit-reversed, which only pointwise and idft rely on
+        static void dft(std::vector<element_type> &a, size_t n)
+        {
+            a.resize(n);
+            ntt_type::prepare(n);
+            ntt_type::dif_core(raw(a.data()), n);
+        }
+        static void idft(std::vector<element_type> &a)
+        {
+            size_t n = a.size();
+            ntt_type::dit_core(raw(a.data()), n);
+            element_type ni = element_type::from_raw(ntt_type::inv_n(n));
+            for (auto &c : a)
+                c *= ni;
+        }
+        static void pointwise(std::vector<element_type> &a, const std::vector<element_type> &b) { ntt_type::pointwise(raw(a.data()), element_type::raw(b.data()), a.size()); }
+        static std::vector<element_type> multiply(const std::vector<element_type> &a, const std::vector<element_type> &b)
+        {
+            if (a.empty() || b.empty())
+                return {};
+            size_t s = a.size() + b.size() - 1, n = 1;
+            if (std::min(a.size(), b.size()) <= MUL_NAIVE_THRESHOLD)
+            {
+                std::vector<element_type> r(s);
+                for (size_t i = 0; i < a.size(); ++i)
+                    for (size_t j = 0; j < b.size(); ++j)
+                        r[i + j] += a[i] * b[j];
+                return r;
+            }
+            while (n < s)
+                n <<= 1;
+            std::vector<element_type> A(a);
+            dft(A, n);
+            if (&a == &b)
+                pointwise(A, A);
+            else
+            {
+                std::vector<element_type> B(b);
+                dft(B, n);
+                pointwise(A, B);
+            }
+            idft(A);
+            A.resize(s);
+            return A;
+        }
+        // 1/i for i in [1, n), by 1/i = -(p/i) * 1/(p mod i)
+        static std::vector<element_type> inverses(size_t n)
+        {
+            using value_type = typename element_type::value_type;
+            std::vector<element_type> iv(std::max<size_t>(n, 2));
+            iv[1] = element_type(1);
+            for (size_t i = 2; i < n; ++i)
+                iv[i] = -iv[_MOD % i] * element_type(value_type(_MOD / i));
+            return iv;
+        }
+        // coefficients [k, k + t) as a polynomial of size t
+        Poly shifted_down(size_t k, size_t t) const
+        {
+            Poly r(t);
+            for (size_t i = 0; i < t && i + k < size(); ++i)
+                r._dat[i] = _dat[i + k];
+            return r;
+        }
+        // Tonelli-Shanks; throws std::domain_error for a non-residue
+        static element_type sqrt_mod(const element_type &a)
+        {
+            if (a == element_type() || _MOD == 2)
+                return a;
+            if (a.pow((_MOD - 1) / 2) != element_type(1))
+                throw std::domain_error("square root does not exist");
+            uint64_t q = _MOD - 1, s = 0;
+            for (; q % 2 == 0; q /= 2)
+                ++s;
+            element_type z(2);
+            while (z.pow((_MOD - 1) / 2) == element_type(1))
+                z += element_type(1);
+            element_type c = z.pow(q), x = a.pow((q + 1) / 2), t = a.pow(q);
+            for (uint64_t m = s; t != element_type(1);)
+            {
+                uint64_t i = 0;
+                for (element_type u = t; u != element_type(1); u *= u)
+                    ++i;
+                element_type b = c;
+                for (uint64_t j = i + 1; j < m; ++j)
+                    b *= b;
+                x *= b, c = b * b, t *= c, m = i;
+            }
+            return x;
+        }
+        // tree[v] = prod (x - xs[i]) over [l, r); ranges up to TREE_LEAF are
+        // multiplied out directly and not split further
+        static void build_tree(std::vector<Poly> &tree, size_t v, size_t l, size_t r, const std::vector<element_type> &xs)
+        {
+            if (r - l <= TREE_LEAF)
+            {
+                Poly &p = tree[v];
+                p._dat.assign(r - l + 1, element_type());
+                p._dat[0] = element_type(1);
+                for (size_t i = l; i < r; ++i)
+                    for (size_t j = i - l + 1; j-- > 0;)
+                        p._dat[j + 1] += p._dat[j], p._dat[j] *= -xs[i];
+                return;
+            }
+            size_t m = l + (r - l) / 2;
+            build_tree(tree, 2 * v, l, m, xs);
+            build_tree(tree, 2 * v + 1, m, r, xs);
+            tree[v] = tree[2 * v] * tree[2 * v + 1];
+        }
+        // f is the polynomial reduced mod tree[v]
+        static void eval_down(const std::vector<Poly> &tree, size_t v, size_t l, size_t r, const Poly &f, const std::vector<element_type> &xs, std::vector<element_type> &ys)
+        {
+            if (r - l <= TREE_LEAF)
+            {
+                for (size_t i = l; i < r; ++i)
+                    ys[i] = f.eval(xs[i]);
+                return;
+            }
+            size_t m = l + (r - l) / 2;
+            eval_down(tree, 2 * v, l, m, f % tree[2 * v], xs, ys);
+            eval_down(tree, 2 * v + 1, m, r, f % tree[2 * v + 1], xs, ys);
+        }
+        // sum of w[i] * tree[v] / (x - xs[i]) over [l, r)
+        static Poly interp_up(const std::vector<Poly> &tree, size_t v, size_t l, size_t r, const std::vector<element_type> &xs, const std::vector<element_type> &w)
+        {
+            if (r - l <= TREE_LEAF)
+            {
+                const Poly &p = tree[v];
+                size_t d = r - l;
+                Poly s(d);
+                for (size_t i = l; i < r; ++i)
+                {
+                    // synthetic division of tree[v] by x - xs[i]
+                    element_type q = p._dat[d];
+                    s._dat[d - 1] += w[i] * q;
+                    for (size_t j = d - 1; j-- > 0;)
+                        q = p._dat[j + 1] + xs[i] * q, s._dat[j] += w[i] * q;
+                }
+                return s;
+            }
+            size_t m = l + (r - l) / 2;
+            return interp_up(tree, 2 * v, l, m, xs, w) * tree[2 * v + 1] + interp_up(tree, 2 * v + 1, m, r, xs, w) * tree[2 * v];
+        }
+    };
+}
@@ -0,0 +1,88 @@
+// FileName : simd.hpp
+// SIMD Runtime Dispatch Header
+// Programmed By MightZero
+// Copyright (c) 2025-2026 MightZero
+#pragma once
+#ifndef _MZLIB_SIMD_HPP
+#define _MZLIB_SIMD_HPP
+#endif
+#include <stdint.h>
+#if !defined(MZLIB_NO_SIMD)&&defined(__GNUC__)&&(defined(__x86_64__)||defined(__i386__))
+#define MZLIB_SIMD_X86 1
+// GCC's own AVX-512 intrinsics trip -Wmaybe-uninitialized through _mm512_undefined_*.
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+#include <immintrin.h>
+#pragma GCC diagnostic pop
+#define MZLIB_TARGET_AVX2 __attribute__((target("avx2")))
+#define MZLIB_TARGET_AVX512 __attribute__((target("avx512f")))
+#define MZLIB_TARGET_AVX2_FMA __attribute__((target("avx2,fma")))
+#else
+#define MZLIB_SIMD_X86 0
+#endif
+
+namespace MZLIB
+{
+    enum class simd_isa{scalar,avx2,avx512};
+    // Widest instruction set usable on the running CPU, probed once through CPUID.
+    // Define MZLIB_NO_SIMD to compile the scalar paths only.
+    inline simd_isa simd_level()
+    {
+#if MZLIB_SIMD_X86
+        static const simd_isa level=[](){
+            __builtin_cpu_init();
+            if(__builtin_cpu_supports("avx512f"))return simd_isa::avx512;
+            if(__builtin_cpu_supports("avx2"))return simd_isa::avx2;
+            return simd_isa::scalar;
+        }();
+        return level;
+#else
+        return simd_isa::scalar;
+#endif
+    }
+    // Whether the CPU has FMA3, which AVX2 floating-point kernels need beyond AVX2.
+    inline bool simd_fma()
+    {
+#if MZLIB_SIMD_X86
+        static const bool fma=[](){
+            __builtin_cpu_init();
+            return __builtin_cpu_supports("fma");
+        }();
+        return fma;
+#else
+        return false;
+#endif
+    }
+#if MZLIB_SIMD_X86
+    // Lane-wise 32-bit Montgomery product a*b*2^(-32) mod m for m<2^31, with
+    // minv=-m^(-1) mod 2^32 broadcast. Even and odd lanes go through separate
+    // 32x32->64 multiplies and are blended back; results match the scalar
+    // reduction bit for bit.
+    MZLIB_TARGET_AVX2 inline __m256i mont_mul_x8(__m256i a,__m256i b,__m256i m,__m256i minv)
+    {
+        __m256i pe=_mm256_mul_epu32(a,b);
+        __m256i po=_mm256_mul_epu32(_mm256_srli_epi64(a,32),_mm256_srli_epi64(b,32));
+        __m256i re=_mm256_add_epi64(pe,_mm256_mul_epu32(_mm256_mul_epu32(pe,minv),m));
+        __m256i ro=_mm256_add_epi64(po,_mm256_mul_epu32(_mm256_mul_epu32(po,minv),m));
+        __m256i r=_mm256_blend_epi32(_mm256_srli_epi64(re,32),ro,0xAA);
+        return _mm256_min_epu32(r,_mm256_sub_epi32(r,m));
+    }
+    // Lane-wise x<2m ? (x>=m ? x-m : x), for m<2^31.
+    MZLIB_TARGET_AVX2 inline __m256i mod_reduce_x8(__m256i x,__m256i m){return _mm256_min_epu32(x,_mm256_sub_epi32(x,m));}
+    // Lane-wise (a+b) mod m and (a-b) mod m for reduced a, b.
+    MZLIB_TARGET_AVX2 inline __m256i add_mod_x8(__m256i a,__m256i b,__m256i m){return mod_reduce_x8(_mm256_add_epi32(a,b),m);}
+    MZLIB_TARGET_AVX2 inline __m256i sub_mod_x8(__m256i a,__m256i b,__m256i m){return mod_reduce_x8(_mm256_sub_epi32(_mm256_add_epi32(a,m),b),m);}
+    MZLIB_TARGET_AVX512 inline __m512i mont_mul_x16(__m512i a,__m512i b,__m512i m,__m512i minv)
+    {
+        __m512i pe=_mm512_mul_epu32(a,b);
+        __m512i po=_mm512_mul_epu32(_mm512_srli_epi64(a,32),_mm512_srli_epi64(b,32));
+        __m512i re=_mm512_add_epi64(pe,_mm512_mul_epu32(_mm512_mul_epu32(pe,minv),m));
+        __m512i ro=_mm512_add_epi64(po,_mm512_mul_epu32(_mm512_mul_epu32(po,minv),m));
+        __m512i r=_mm512_mask_blend_epi32(0xAAAA,_mm512_srli_epi64(re,32),ro);
+        return _mm512_min_epu32(r,_mm512_sub_epi32(r,m));
+    }
+    MZLIB_TARGET_AVX512 inline __m512i mod_reduce_x16(__m512i x,__m512i m){return _mm512_min_epu32(x,_mm512_sub_epi32(x,m));}
+    MZLIB_TARGET_AVX512 inline __m512i add_mod_x16(__m512i a,__m512i b,__m512i m){return mod_reduce_x16(_mm512_add_epi32(a,b),m);}
+    MZLIB_TARGET_AVX512 inline __m512i sub_mod_x16(__m512i a,__m512i b,__m512i m){return mod_reduce_x16(_mm512_sub_epi32(_mm512_add_epi32(a,m),b),m);}
+#endif
+}
@@ -9,6 +9,18 @@
 #include<type_traits>
 #include<chrono>
 #include<utility>
+#include<variant>
+#include<atomic>
+#include<exception>
+#include<mutex>
+#include<thread>
+#include<vector>
+#include<algorithm>
+#include<cstddef>
+#include<cstring>
+#include<iterator>
+#include<initializer_list>
+#include<new>
 
 namespace MZLIB
 {
@@ -30,6 +42,49 @@ namespace MZLIB
         }
     }
 
+    // Runs func(i) for every i in [0, tasks) on up to threads workers, the calling
+    // thread included. The first exception thrown by a task is rethrown here
+    // after all workers have stopped.
+    template <typename _Func>
+    inline void parallel_run(size_t tasks, size_t threads, _Func &&func)
+    {
+        if (threads > tasks)
+            threads = tasks;
+        if (threads <= 1)
+        {
+            for (size_t i = 0; i < tasks; ++i)
+                func(i);
+            return;
+        }
+        std::atomic<size_t> next(0);
+        std::exception_ptr error;
+        std::mutex error_mutex;
+        auto worker = [&]()
+        {
+            try
+            {
+                for (size_t i; (i = next.fetch_add(1)) < tasks;)
+                    func(i);
+            }
+            catch (...)
+            {
+                std::lock_guard<std::mutex> lock(error_mutex);
+                if (!error)
+                    error = std::current_exception();
+                next.store(tasks);
+            }
+        };
+        std::vector<std::thread> pool;
+        pool.reserve(threads - 1);
+        for (size_t t = 1; t < threads; ++t)
+            pool.emplace_back(worker);
+        worker();
+        for (auto &th : pool)
+            th.join();
+        if (error)
+            std::rethrow_exception(error);
+    }
+
     template<typename _T>
     class range
     {
@@ -63,5 +118,211 @@ namespace MZLIB
         iterator begin() { return iterator(_L); }
         iterator end() { return iterator(_R); }
     };
+
+    // std::vector-compatible container with inline room for _N elements: up to
+    // _N elements live inside the object and never touch the heap, larger sizes
+    // move to a heap buffer grown geometrically. Limited to trivially copyable
+    // types so elements are relocated with memcpy. Works as the _Container of a
+    // BigInt (see SmallBigInt).
+    template <typename _T, size_t _N>
+    class SmallVector
+    {
+        static_assert(std::is_trivially_copyable_v<_T>, "SmallVector needs a trivially copyable type");
+        static_assert(_N > 0, "SmallVector needs inline room");
+
+    public:
+        using value_type = _T;
+        using size_type = size_t;
+        using difference_type = ptrdiff_t;
+        using reference = _T &;
+        using const_reference = const _T &;
+        using pointer = _T *;
+        using const_pointer = const _T *;
+        using iterator = _T *;
+        using const_iterator = const _T *;
+        using reverse_iterator = std::reverse_iterator<iterator>;
+        using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+
+        SmallVector() : _ptr(_buf), _size(0), _cap(_N) {}
+        explicit SmallVector(size_t n) : SmallVector() { resize(n); }
+        SmallVector(size_t n, const _T &v) : SmallVector() { assign(n, v); }
+        template <typename _It, typename = std::enable_if_t<!std::is_integral_v<_It>>>
+        SmallVector(_It first, _It last) : SmallVector() { assign(first, last); }
+        SmallVector(std::initializer_list<_T> il) : SmallVector() { assign(il.begin(), il.end()); }
+        SmallVector(const SmallVector &_rhs) : SmallVector() { assign(_rhs.begin(), _rhs.end()); }
+        SmallVector(SmallVector &&_rhs) noexcept : SmallVector() { steal(_rhs); }
+        ~SmallVector() { release(); }
+        SmallVector &operator=(const SmallVector &_rhs)
+        {
+            if (this != &_rhs)
+                assign(_rhs.begin(), _rhs.end());
+            return *this;
+        }
+        SmallVector &operator=(SmallVector &&_rhs) noexcept
+        {
+            if (this != &_rhs)
+                release(), _ptr = _buf, _size = 0, _cap = _N, steal(_rhs);
+            return *this;
+        }
+        SmallVector &operator=(std::initializer_list<_T> il) { return assign(il.begin(), il.end()), *this; }
+
+        void assign(size_t n, const _T &v)
+        {
+            _T t = v;
+            _size = 0;
+            reserve(n);
+            std::fill_n(_ptr, n, t);
+            _size = n;
+        }
+        template <typename _It, typename = std::enable_if_t<!std::is_integral_v<_It>>>
+        void assign(_It first, _It last)
+        {
+            _size = 0;
+            if constexpr (std::is_base_of_v<std::forward_iterator_tag, typename std::iterator_traits<_It>::iterator_category>)
+            {
+                reserve(size_t(std::distance(first, last)));
+                _size = size_t(std::copy(first, last, _ptr) - _ptr);
+            }
+            else
+                for (; first != last; ++first)
+                    push_back(*first);
+        }
+        void assign(std::initializer_list<_T> il) { assign(il.begin(), il.end()); }
+
+        iterator begin() { return _ptr; }
+        iterator end() { return _ptr + _size; }
+        const_iterator begin() const { return _ptr; }
+        const_iterator end() const { return _ptr + _size; }
+        const_iterator cbegin() const { return _ptr; }
+        const_iterator cend() const { return _ptr + _size; }
+        reverse_iterator rbegin() { return reverse_iterator(end()); }
+        reverse_iterator rend() { return reverse_iterator(begin()); }
+        const_reverse_iterator rbegin() const { return const_reverse_iterator(end()); }
+        const_reverse_iterator rend() const { return const_reverse_iterator(begin()); }
+
+        size_t size() const { return _size; }
+        size_t capacity() const { return _cap; }
+        bool empty() const { return !_size; }
+        // whether the elements are held in the inline buffer
+        bool is_inline() const { return _ptr == _buf; }
+        _T *data() { return _ptr; }
+        const _T *data() const { return _ptr; }
+        _T &operator[](size_t i) { return _ptr[i]; }
+        const _T &operator[](size_t i) const { return _ptr[i]; }
+        _T &front() { return _ptr[0]; }
+        const _T &front() const { return _ptr[0]; }
+        _T &back() { return _ptr[_size - 1]; }
+        const _T &back() const { return _ptr[_size - 1]; }
+
+        void reserve(size_t n)
+        {
+            if (n > _cap)
+                regrow(n);
+        }
+        void resize(size_t n) { resize(n, _T()); }
+        void resize(size_t n, const _T &v)
+        {
+            if (n > _size)
+            {
+                _T t = v;
+                if (n > _cap)
+                    regrow(std::max(n, 2 * _cap));
+                std::fill(_ptr + _size, _ptr + n, t);
+            }
+            _size = n;
+        }
+        void clear() { _size = 0; }
+        void push_back(const _T &v)
+        {
+            if (_size == _cap)
+            {
+                _T t = v;
+                regrow(2 * _cap);
+                _ptr[_size++] = t;
+            }
+            else
+                _ptr[_size++] = v;
+        }
+        template <typename... _Arg>
+        _T &emplace_back(_Arg &&...args) { return push_back(_T(std::forward<_Arg>(args)...)), back(); }
+        void pop_back() { --_size; }
+        iterator insert(const_iterator pos, const _T &v) { return insert(pos, size_t(1), v); }
+        iterator insert(const_iterator pos, size_t n, const _T &v)
+        {
+            _T t = v;
+            size_t i = open_gap(pos, n);
+            std::fill_n(_ptr + i, n, t);
+            return _ptr + i;
+        }
+        template <typename _It, typename = std::enable_if_t<!std::is_integral_v<_It>>>
+        iterator insert(const_iterator pos, _It first, _It last)
+        {
+            SmallVector tmp(first, last);
+            size_t i = open_gap(pos, tmp.size());
+            std::copy(tmp.begin(), tmp.end(), _ptr + i);
+            return _ptr + i;
+        }
+        iterator erase(const_iterator first, const_iterator last)
+        {
+            size_t i = size_t(first - _ptr), n = size_t(last - first);
+            std::memmove(_ptr + i, _ptr + i + n, (_size - i - n) * sizeof(_T));
+            _size -= n;
+            return _ptr + i;
+        }
+        iterator erase(const_iterator pos) { return erase(pos, pos + 1); }
+        void swap(SmallVector &_rhs) noexcept
+        {
+            SmallVector t(std::move(_rhs));
+            _rhs = std::move(*this);
+            *this = std::move(t);
+        }
+        friend void swap(SmallVector &_lhs, SmallVector &_rhs) noexcept { _lhs.swap(_rhs); }
+        friend bool operator==(const SmallVector &_lhs, const SmallVector &_rhs)
+        {
+            return _lhs._size == _rhs._size && std::equal(_lhs.begin(), _lhs.end(), _rhs.begin());
+        }
+        friend bool operator!=(const SmallVector &_lhs, const SmallVector &_rhs) { return !(_lhs == _rhs); }
+
+    private:
+        _T *_ptr;
+        size_t _size, _cap;
+        _T _buf[_N];
+
+        void regrow(size_t cap)
+        {
+            _T *p = static_cast<_T *>(::operator new(cap * sizeof(_T)));
+            if (_size)
+                std::memcpy(p, _ptr, _size * sizeof(_T));
+            release();
+            _ptr = p, _cap = cap;
+        }
+        void release()
+        {
+            if (_ptr != _buf)
+                ::operator delete(_ptr);
+        }
+        // takes _rhs's elements (heap buffers by pointer), leaving _rhs empty and inline
+        void steal(SmallVector &_rhs)
+        {
+            if (_rhs._ptr == _rhs._buf)
+            {
+                std::memcpy(_buf, _rhs._buf, _rhs._size * sizeof(_T));
+                _size = _rhs._size;
+            }
+            else
+                _ptr = _rhs._ptr, _size = _rhs._size, _cap = _rhs._cap;
+            _rhs._ptr = _rhs._buf, _rhs._size = 0, _rhs._cap = _N;
+        }
+        // shifts [pos,end) up by n and returns pos as an index
+        size_t open_gap(const_iterator pos, size_t n)
+        {
+            size_t i = size_t(pos - _ptr);
+            if (_size + n > _cap)
+                regrow(std::max(_size + n, 2 * _cap));
+            std::memmove(_ptr + i + n, _ptr + i, (_size - i) * sizeof(_T));
+            _size += n;
+            return i;
+        }
+    };
     
 }
\ No newline at end of file